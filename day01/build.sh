@@ -3,8 +3,13 @@
 HOST_DIR=$(pwd)
 
 COMMON="-Wall -Wno-unused-variable -Wno-missing-braces -Wno-unused-function -Wno-switch -Wno-unused-command-line-argument -Werror -Wvla -Wgnu-folding-constant"
+# x86-64-v3 enables AVX2, BMI and LZCNT for the SIMD kernels. It is opt in ("avx2" as the
+# second argument) since the binary then won't run on older cpus, the default build uses the
+# SSE2/scalar kernels.
+ARCH="-march=x86-64-v3"
 DEBUG="-DDEBUG_BUILD -g"
 RELEASE="-DOPTIMIZATION_BUILD -O3"
+BENCHMARK="-DBENCHMARK_BUILD"
 
 FLAGS=
 
@@ -12,12 +17,20 @@ MODE=
 if [ "$1" = "release" ]; then
     MODE=release
     FLAGS="$COMMON $RELEASE"
+elif [ "$1" = "bench" ]; then
+    MODE=benchmark
+    FLAGS="$COMMON $RELEASE $BENCHMARK"
 else
     MODE=debug
     FLAGS="$COMMON $DEBUG"
 fi
 
+if [ "$2" = "avx2" ]; then
+    MODE="$MODE avx2"
+    FLAGS="$FLAGS $ARCH"
+fi
+
 echo Building in $MODE mode.
 
-echo clang $FLAGS code/main.c -o advent
-clang $FLAGS code/main.c -o advent
\ No newline at end of file
+echo clang $FLAGS code/main.c -o advent -lpthread
+clang $FLAGS code/main.c -o advent -lpthread
\ No newline at end of file
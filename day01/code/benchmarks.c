@@ -0,0 +1,1760 @@
+// -------------------------------------------------------------------
+// Benchmarks
+//
+// Built with "./build.sh bench". Each benchmark runs the competing implementations over
+// the same input and reports the time and a checksum, the checksums must match. Inputs come
+// from bench_random so every run sees the same data, and every timing goes through BenchTime.
+// The check_ functions next to a benchmark cover the edge cases its timed input doesn't reach,
+// they all run before the first timing.
+
+#include <stdio.h>  // sscanf, the baseline for the number parsers
+#include <string.h> // The libc memory functions, the baseline for chibi_memory
+
+#define BENCHMARK_REPEAT_COUNT 16
+#define BENCHMARK_SEED         0x9E3779B97F4A7C15ull
+
+// xorshift64
+fn_inline u64
+bench_random(u64* State)
+{
+    u64 Value = *State;
+    Value ^= Value << 13; Value ^= Value >> 7; Value ^= Value << 17;
+    *State = Value;
+    return Value;
+}
+
+// Runs the statement that follows once and stores its wall clock time in OutMs.
+#define BenchTime(OutMs) \
+    for (f64 BenchBegin_ = wall_clock_ms(), BenchDone_ = 0; !BenchDone_; (OutMs) = wall_clock_ms() - BenchBegin_, BenchDone_ = 1)
+
+// Spelled out digits packed into little endian integers, along with the mask for the
+// number of bytes in the word.
+#define PACK3(A, B, C)       ((u64)(A) | ((u64)(B) << 8) | ((u64)(C) << 16))
+#define PACK4(A, B, C, D)    (PACK3(A, B, C) | ((u64)(D) << 24))
+#define PACK5(A, B, C, D, E) (PACK4(A, B, C, D) | ((u64)(E) << 32))
+
+#define WORD_MASK3 0xFFFFFFllu
+#define WORD_MASK4 0xFFFFFFFFllu
+#define WORD_MASK5 0xFFFFFFFFFFllu
+
+// No letter starts more than two words, so the first byte selects (at most) two candidates.
+// The table stores Digit + 1 so the zero initialized entries decode to -1 (no match).
+typedef struct
+{
+    u64 Word[2];
+    u64 Mask[2];
+    s8  DigitPlusOne[2];
+} word_candidates;
+
+var_global const word_candidates cWordCandidates[256] = {
+    ['z'] = { { PACK4('z','e','r','o')     },                            { WORD_MASK4 },             { 1 }     },
+    ['o'] = { { PACK3('o','n','e')         },                            { WORD_MASK3 },             { 2 }     },
+    ['t'] = { { PACK3('t','w','o'),         PACK5('t','h','r','e','e') }, { WORD_MASK3, WORD_MASK5 }, { 3, 4 }  },
+    ['f'] = { { PACK4('f','o','u','r'),     PACK4('f','i','v','e')     }, { WORD_MASK4, WORD_MASK4 }, { 5, 6 }  },
+    ['s'] = { { PACK3('s','i','x'),         PACK5('s','e','v','e','n') }, { WORD_MASK3, WORD_MASK5 }, { 7, 8 }  },
+    ['e'] = { { PACK5('e','i','g','h','t') },                            { WORD_MASK5 },             { 9 }     },
+    ['n'] = { { PACK4('n','i','n','e')     },                            { WORD_MASK4 },             { 10 }    },
+};
+
+// Same result as is_word_digit_compare. Loads up to 8 bytes at Digit into a u64 and compares
+// it against the packed candidates for its first letter. Bytes past Length are zero, which
+// never matches a letter, so a word cut off by the end of the line can't match.
+//
+// Part 2 matches words with the Aho-Corasick automata in main.c, this only competes with
+// is_word_digit_compare here.
+fn_inline int is_word_digit_packed(char* Digit, int Length)
+{
+    u64 Word = 0;
+    if (Length >= 8) __builtin_memcpy(&Word, Digit, 8);
+    else             __builtin_memcpy(&Word, Digit, Length);
+
+    // At most one candidate can match. Empty slots have a zero mask and word, so they always
+    // "match", but with a value of 0, which keeps the sum branch free.
+    const word_candidates* Candidates = &cWordCandidates[(u8)Word];
+
+    int Match0 = (Word & Candidates->Mask[0]) == Candidates->Word[0];
+    int Match1 = (Word & Candidates->Mask[1]) == Candidates->Word[1];
+    return Match0 * Candidates->DigitPlusOne[0] + Match1 * Candidates->DigitPlusOne[1] - 1;
+}
+
+typedef int word_digit_fn(char* Digit, int Length);
+
+fn_internal f64
+bench_word_digit(word_digit_fn* Fn, char* Input, int InputSize, s64* OutChecksum)
+{
+    s64 Checksum = 0;
+    f64 Time     = 0;
+
+    BenchTime(Time) ForRange(int, Repeat, BENCHMARK_REPEAT_COUNT)
+    {
+        ForRange(int, i, InputSize)
+            Checksum += Fn(Input + i, InputSize - i);
+    }
+
+    *OutChecksum = Checksum;
+    return Time;
+}
+
+fn_internal void
+compare_word_digit(const char* Name, char* Input, int InputSize)
+{
+    ForRange(int, i, InputSize)
+        cassert(is_word_digit_compare(Input + i, InputSize - i) == is_word_digit_packed(Input + i, InputSize - i));
+
+    s64 CompareChecksum = 0;
+    s64 PackedChecksum  = 0;
+
+    f64 CompareTime = bench_word_digit(is_word_digit_compare, Input, InputSize, &CompareChecksum);
+    f64 PackedTime  = bench_word_digit(is_word_digit_packed,  Input, InputSize, &PackedChecksum);
+
+    log_info("is_word_digit (%s, %d bytes x %d)", Name, InputSize, BENCHMARK_REPEAT_COUNT);
+    log_info("    string_compare: %lf ms (checksum %ld)", CompareTime, CompareChecksum);
+    log_info("    packed words:   %lf ms (checksum %ld)", PackedTime,  PackedChecksum);
+    cassert(CompareChecksum == PackedChecksum);
+}
+
+fn_internal void
+bench_is_word_digit()
+{
+    file_io_read_result Result = platform_read_entire_file("input_p2.txt");
+    cassert(Result.Error == file_io_none);
+    compare_word_digit("input_p2.txt", Result.FileData, (int)Result.FileSize);
+    mem_free(Result.FileData);
+
+    // Worst case for the compare chain: every position starts with the first letters of a
+    // word and only fails on the last letter, so every branch of the switch runs to the end.
+    const char* NearMisses[] = {
+        "zerx", "onx", "twx", "threx", "foux", "fivx", "sxx", "sevex", "eighx", "ninx",
+    };
+
+    int SyntheticSize = _MB(1);
+    char* Synthetic = mem_alloc(char, SyntheticSize);
+
+    int Offset = 0;
+    u64 State  = BENCHMARK_SEED;
+    while (Offset < SyntheticSize)
+    {
+        const char* Word = NearMisses[bench_random(&State) % ArrayCount(NearMisses)];
+        int WordLength = (int)string_len(Word);
+        if (Offset + WordLength > SyntheticSize) WordLength = SyntheticSize - Offset;
+
+        mem_copy(Synthetic + Offset, Word, WordLength);
+        Offset += WordLength;
+    }
+
+    compare_word_digit("synthetic near misses", Synthetic, SyntheticSize);
+    mem_free(Synthetic);
+}
+
+#define BENCHMARK_NODE_COUNT 1000000
+
+typedef struct bench_node
+{
+    struct bench_node* Left;
+    struct bench_node* Right;
+    s64                Value;
+    s64                Pad;
+} bench_node;
+
+typedef enum
+{
+    node_allocator_malloc,
+    node_allocator_pool,
+    node_allocator_pool_cache,
+} node_allocator;
+
+fn_internal bench_node*
+bench_node_alloc(node_allocator Allocator, memory_pool* Pool, pool_cache* Cache)
+{
+    switch (Allocator)
+    {
+        case node_allocator_malloc:     return (bench_node*)malloc(sizeof(bench_node));
+        case node_allocator_pool:       return pool_alloc_type(Pool, bench_node);
+        case node_allocator_pool_cache: return (bench_node*)pool_cache_alloc(Cache);
+    }
+    return NULL;
+}
+
+fn_internal void
+bench_node_free(node_allocator Allocator, memory_pool* Pool, pool_cache* Cache, bench_node* Node)
+{
+    switch (Allocator)
+    {
+        case node_allocator_malloc:     free(Node);                   break;
+        case node_allocator_pool:       pool_free(Pool, Node);        break;
+        case node_allocator_pool_cache: pool_cache_free(Cache, Node); break;
+    }
+}
+
+// Allocates every node, frees every other one, fills the holes back in, then frees it all.
+fn_internal f64
+bench_node_churn(node_allocator Allocator, bench_node** Nodes, s64* OutChecksum)
+{
+    memory_pool Pool  = pool_init_type(bench_node, BENCHMARK_NODE_COUNT);
+    pool_cache  Cache = pool_cache_init(&Pool);
+    s64 Checksum = 0;
+    f64 Time     = 0;
+
+    BenchTime(Time) ForRange(int, Repeat, BENCHMARK_REPEAT_COUNT)
+    {
+        ForRange(int, i, BENCHMARK_NODE_COUNT)
+        {
+            Nodes[i] = bench_node_alloc(Allocator, &Pool, &Cache);
+            Nodes[i]->Value = i;
+        }
+
+        for (int i = 0; i < BENCHMARK_NODE_COUNT; i += 2)
+            bench_node_free(Allocator, &Pool, &Cache, Nodes[i]);
+
+        for (int i = 0; i < BENCHMARK_NODE_COUNT; i += 2)
+        {
+            Nodes[i] = bench_node_alloc(Allocator, &Pool, &Cache);
+            Nodes[i]->Value = -i;
+        }
+
+        ForRange(int, i, BENCHMARK_NODE_COUNT)
+        {
+            Checksum += Nodes[i]->Value;
+            bench_node_free(Allocator, &Pool, &Cache, Nodes[i]);
+        }
+    }
+
+    pool_cache_flush(&Cache);
+    pool_release(&Pool);
+
+    *OutChecksum = Checksum;
+    return Time;
+}
+
+// Exhausting the reserve, free list reuse, and a reset while a cache still holds blocks
+fn_internal void
+check_pool()
+{
+    // Blocks smaller than the free list link are padded up to it
+    memory_pool Tiny = pool_init(1, 1, 1);
+    cassert(Tiny.BlockSize == sizeof(pool_block));
+    pool_release(&Tiny);
+
+    u64 BlockCount = POOL_COMMIT_SIZE / 32;
+    memory_pool Pool = pool_init(24, 32, BlockCount);
+    cassert(Pool.Base && Pool.BlockSize == 32 && Pool.ReserveSize == POOL_COMMIT_SIZE);
+
+    u8* Previous = NULL;
+    ForRange(u64, i, BlockCount)
+    {
+        u8* Block = (u8*)pool_alloc(&Pool);
+        cassert(Block && ((u64)Block & 31) == 0 && Block > Previous);
+        cassert(Block + Pool.BlockSize <= Pool.Base + Pool.ReserveSize);
+        Previous = Block;
+    }
+    cassert(pool_alloc(&Pool) == NULL); // Out of reserved space
+
+    // The last block freed is the first handed out again
+    u8* First = Pool.Base;
+    pool_free(&Pool, NULL);
+    pool_free(&Pool, First);
+    pool_free(&Pool, Previous);
+    cassert(pool_alloc(&Pool) == Previous);
+    cassert(pool_alloc(&Pool) == First);
+    cassert(pool_alloc(&Pool) == NULL);
+
+    u32 Generation = Pool.Generation;
+    pool_reset(&Pool);
+    cassert(Pool.Generation == Generation + 1 && Pool.FreeList == NULL);
+    cassert(pool_alloc(&Pool) == First);
+
+    // Blocks a cache took before a reset belong to the pool again afterwards, the cache has to
+    // drop them instead of handing them out or flushing them back.
+    pool_reset(&Pool);
+    pool_cache Cache = pool_cache_init(&Pool);
+    u8* Cached = (u8*)pool_cache_alloc(&Cache);
+    cassert(Cached == First && Cache.Count == POOL_CACHE_BATCH - 1);
+    pool_cache_free(&Cache, Cached);
+
+    pool_reset(&Pool);
+    u8* Fresh = (u8*)pool_alloc(&Pool);
+    cassert(Fresh == First);
+    u8* AfterReset = (u8*)pool_cache_alloc(&Cache);
+    cassert(AfterReset != Fresh && Cache.Generation == Pool.Generation);
+
+    pool_reset(&Pool);
+    pool_cache_flush(&Cache);
+    cassert(Cache.Count == 0 && Cache.FreeList == NULL && Pool.FreeList == NULL);
+
+    pool_release(&Pool);
+    cassert(Pool.Base == NULL);
+}
+
+fn_internal void
+bench_pool()
+{
+    bench_node** Nodes = mem_alloc(bench_node*, BENCHMARK_NODE_COUNT);
+
+    s64 MallocChecksum = 0;
+    s64 PoolChecksum   = 0;
+    s64 CacheChecksum  = 0;
+
+    f64 MallocTime = bench_node_churn(node_allocator_malloc,     Nodes, &MallocChecksum);
+    f64 PoolTime   = bench_node_churn(node_allocator_pool,       Nodes, &PoolChecksum);
+    f64 CacheTime  = bench_node_churn(node_allocator_pool_cache, Nodes, &CacheChecksum);
+
+    log_info("node churn (%d x %d byte nodes x %d)", BENCHMARK_NODE_COUNT, (int)sizeof(bench_node), BENCHMARK_REPEAT_COUNT);
+    log_info("    malloc:     %lf ms (checksum %ld)", MallocTime, MallocChecksum);
+    log_info("    pool:       %lf ms (checksum %ld)", PoolTime,   PoolChecksum);
+    log_info("    pool cache: %lf ms (checksum %ld)", CacheTime,  CacheChecksum);
+    cassert(MallocChecksum == PoolChecksum && MallocChecksum == CacheChecksum);
+
+    mem_free(Nodes);
+}
+
+#define BENCHMARK_ARRAY_COUNT 16000000
+
+typedef struct { u8 Bytes[3]; } check_triple;
+DARRAY_DEFINE(check_triple)
+
+// Empty arrays, growth that keeps the contents, and an element size that isn't a power of 2
+fn_internal void
+check_darray_typed()
+{
+    darray_s32 Empty = {0};
+    darray_s32_append_n(&Empty, NULL, 0);
+    darray_s32_reserve(&Empty, 0);
+    cassert(Empty.Data == NULL && Empty.Length == 0 && Empty.Capacity == 0);
+    darray_s32_free(&Empty);
+
+    darray_s32 Array = {0};
+    darray_s32_push(&Array, -1);
+    cassert(Array.Length == 1 && Array.Capacity == DARRAY_TYPED_MIN_CAPACITY);
+
+    // Reserving less than the capacity doesn't move the data
+    s32* Data = Array.Data;
+    darray_s32_reserve(&Array, 2);
+    cassert(Array.Data == Data);
+
+    s32 Values[1000];
+    ForRange(s32, i, ArrayCount(Values)) Values[i] = i * 7;
+    darray_s32_append_n(&Array, Values, ArrayCount(Values));
+    cassert(Array.Length == ArrayCount(Values) + 1 && Array.Capacity >= Array.Length);
+    cassert(darray_s32_get(&Array, 0) == -1);
+    ForRange(u64, i, ArrayCount(Values))
+        cassert(darray_s32_get(&Array, i + 1) == Values[i]);
+
+    cassert(darray_s32_pop(&Array) == Values[ArrayCount(Values) - 1]);
+    u64 Capacity = Array.Capacity;
+    darray_s32_clear(&Array);
+    cassert(Array.Length == 0 && Array.Capacity == Capacity);
+    darray_s32_free(&Array);
+    cassert(Array.Data == NULL && Array.Capacity == 0);
+
+    darray_check_triple Triples = {0};
+    ForRange(u32, i, 100)
+    {
+        check_triple Triple = {{ (u8)i, (u8)(i + 1), (u8)(i + 2) }};
+        darray_check_triple_push(&Triples, Triple);
+    }
+    ForRange(u32, i, 100)
+    {
+        check_triple* Triple = darray_check_triple_at(&Triples, i);
+        cassert(Triple->Bytes[0] == (u8)i && Triple->Bytes[2] == (u8)(i + 2));
+    }
+    darray_check_triple_free(&Triples);
+}
+
+// The bulk operations at the ends of the array and across a resize
+fn_internal void
+check_darray_bulk()
+{
+    s32 Values[64];
+    ForRange(s32, i, ArrayCount(Values)) Values[i] = i;
+
+    s32* Array = darray_reserve(s32, 8);
+    darray_reserve_exact(Array, 4);
+    cassert(darray_cap(Array) == 8);
+    darray_reserve_exact(Array, 13);
+    cassert(darray_cap(Array) == 13 && darray_len(Array) == 0);
+
+    // Crosses the capacity of 13 in one call
+    darray_append_n(Array, Values, 10);
+    darray_append_n(Array, Values + 10, 20);
+    cassert(darray_len(Array) == 30 && darray_cap(Array) >= 30);
+    ForRange(s32, i, 30) cassert(Array[i] == i);
+
+    // Insert at the front and at the end, -3 -2 -1 0..29 30 31
+    s32 Front[3] = { -3, -2, -1 };
+    darray_insert_range(Array, 0, Front, 3);
+    darray_insert_range(Array, darray_len(Array), Values + 30, 2);
+    cassert(darray_len(Array) == 35);
+    ForRange(s32, i, 35) cassert(Array[i] == i - 3);
+
+    // Past the end is ignored
+    darray_insert_range(Array, darray_len(Array) + 1, Values, 1);
+    cassert(darray_len(Array) == 35);
+
+    // Erasing past the end is ignored, a range running off the end stops at it
+    darray_erase_range(Array, 35, 1);
+    cassert(darray_len(Array) == 35);
+    darray_erase_range(Array, 0, 3);
+    cassert(darray_len(Array) == 32 && Array[0] == 0);
+    darray_erase_range(Array, 30, 100);
+    cassert(darray_len(Array) == 30 && Array[29] == 29);
+    darray_erase_range(Array, 10, 5);
+    cassert(darray_len(Array) == 25 && Array[9] == 9 && Array[10] == 15 && Array[24] == 29);
+
+    // Shrinking keeps the capacity and the remaining elements, growing keeps the old ones
+    u64 Capacity = darray_cap(Array);
+    darray_resize_uninit(Array, 5);
+    cassert(darray_len(Array) == 5 && darray_cap(Array) == Capacity);
+    darray_resize_uninit(Array, Capacity * 3);
+    cassert(darray_len(Array) == Capacity * 3 && darray_cap(Array) >= Capacity * 3);
+    ForRange(s32, i, 5) cassert(Array[i] == i);
+    darray_resize_uninit(Array, 0);
+    cassert(darray_len(Array) == 0);
+
+    darray_free(Array);
+}
+
+// Pushes that fill the capacity exactly, and virtual arrays growing in place up to MaxCapacity
+fn_internal void
+check_darray_virtual()
+{
+    s32* Heap = darray_reserve(s32, 4);
+    ForRange(s32, i, 4) darray_push(Heap, i);
+    cassert(darray_len(Heap) == 4 && darray_cap(Heap) == 4);
+    darray_push(Heap, 4);
+    cassert(darray_len(Heap) == 5 && darray_cap(Heap) >= 5);
+    ForRange(s32, i, 5) cassert(Heap[i] == i);
+    darray_free(Heap);
+
+    // The header and the elements fill exactly one page, every push fits without growing
+    u64 PageSize  = platform_get_page_size();
+    u64 PageCount = PageSize - sizeof(u64) * darray_field_length;
+    u8* Page = darray_init_virtual(u8, PageCount);
+    cassert(Page && darray_cap(Page) == PageCount);
+    ForRange(u64, i, PageCount) darray_push(Page, (u8)i);
+    cassert(darray_len(Page) == PageCount && darray_cap(Page) == PageCount);
+    ForRange(u64, i, PageCount) cassert(Page[i] == (u8)i);
+    darray_free(Page);
+
+    // Pushes commit pages behind the first one without moving the array
+    u64 MaxCapacity = 1 << 20;
+    u32* Array = darray_init_virtual(u32, MaxCapacity);
+    cassert(Array != NULL);
+    u32* Base  = Array;
+    u32* First = &Array[0];
+    u64 InitialCapacity = darray_cap(Array);
+    cassert(InitialCapacity < MaxCapacity);
+
+    ForRange(u32, i, InitialCapacity * 3) darray_push(Array, i);
+    cassert(Array == Base && darray_cap(Array) > InitialCapacity);
+
+    // Bulk growth goes through the same path
+    u32 Values[1000];
+    ForRange(u32, i, ArrayCount(Values)) Values[i] = (u32)(InitialCapacity * 3 + i);
+    darray_append_n(Array, Values, ArrayCount(Values));
+    darray_reserve_exact(Array, MaxCapacity / 2);
+    cassert(Array == Base && darray_cap(Array) >= MaxCapacity / 2);
+
+    // Fill to MaxCapacity, the last push has to fit
+    for (u64 i = darray_len(Array); i < MaxCapacity; ++i) darray_push(Array, (u32)i);
+    cassert(Array == Base && First == &Array[0] && darray_len(Array) == MaxCapacity);
+    cassert(darray_cap(Array) >= MaxCapacity);
+    ForRange(u64, i, MaxCapacity) cassert(Array[i] == (u32)i);
+    darray_free(Array);
+}
+
+// Pushes every value then sums the array, with the runtime stride darray and with darray_s32.
+fn_internal void
+bench_darray()
+{
+    s64 UntypedChecksum = 0;
+    s64 TypedChecksum   = 0;
+    f64 UntypedTime     = 0;
+    f64 TypedTime       = 0;
+
+    BenchTime(UntypedTime)
+    {
+        s32* Array = darray_init(s32);
+        ForRange(s32, i, BENCHMARK_ARRAY_COUNT)
+            darray_push(Array, i ^ 0x5555);
+
+        u64 Length = darray_len(Array);
+        ForRange(u64, i, Length)
+            UntypedChecksum += Array[i];
+        darray_free(Array);
+    }
+    BenchTime(TypedTime)
+    {
+        darray_s32 Array = {0};
+        ForRange(s32, i, BENCHMARK_ARRAY_COUNT)
+            darray_s32_push(&Array, i ^ 0x5555);
+
+        ForRange(u64, i, Array.Length)
+            TypedChecksum += darray_s32_get(&Array, i);
+        darray_s32_free(&Array);
+    }
+
+    log_info("darray push + sum (%d s32)", BENCHMARK_ARRAY_COUNT);
+    log_info("    darray:     %lf ms (checksum %ld)", UntypedTime, UntypedChecksum);
+    log_info("    darray_s32: %lf ms (checksum %ld)", TypedTime,   TypedChecksum);
+    cassert(UntypedChecksum == TypedChecksum);
+}
+
+SMALL_ARRAY_DEFINE(s32, 16)
+
+// The push that fills the inline storage, the one that spills, copies while inline, and
+// spilling in to an arena
+fn_internal void
+check_small_array()
+{
+    small_array_s32_16 Array = {0};
+    cassert(small_array_s32_16_len(&Array) == 0 && small_array_s32_16_cap(&Array) == 16);
+    cassert(small_array_s32_16_data(&Array) == Array.Inline);
+
+    ForRange(s32, i, 16) small_array_s32_16_push(&Array, i);
+    cassert(Array.Data == NULL && small_array_s32_16_len(&Array) == 16);
+
+    // Inline arrays are plain values
+    small_array_s32_16 Copy = Array;
+    small_array_s32_16_set(&Copy, 0, -1);
+    cassert(small_array_s32_16_get(&Array, 0) == 0);
+
+    small_array_s32_16_push(&Array, 16);
+    cassert(Array.Data != NULL && small_array_s32_16_cap(&Array) >= 17);
+    ForRange(s32, i, 17) cassert(small_array_s32_16_get(&Array, i) == i);
+
+    ForRange(s32, i, 100) small_array_s32_16_push(&Array, 17 + i);
+    ForRange(s32, i, 117) cassert(small_array_s32_16_get(&Array, i) == i);
+    cassert(small_array_s32_16_pop(&Array) == 116);
+
+    s32* Spilled = Array.Data;
+    small_array_s32_16_clear(&Array);
+    cassert(Array.Length == 0 && Array.Data == Spilled);
+    small_array_s32_16_free(&Array);
+    cassert(Array.Data == NULL && small_array_s32_16_data(&Array) == Array.Inline);
+
+    memory_arena Arena = arena_init(_MB(1));
+    small_array_s32_16 InArena = {0};
+    InArena.Arena = &Arena;
+    ForRange(s32, i, 40) small_array_s32_16_push(&InArena, i);
+    cassert((u8*)InArena.Data >= Arena.Base && (u8*)InArena.Data < Arena.Base + Arena.Pos);
+    ForRange(s32, i, 40) cassert(small_array_s32_16_get(&InArena, i) == i);
+    small_array_s32_16_free(&InArena);
+    arena_release(&Arena);
+}
+
+// Builds a short list of the digits on every line and sums it, the way a solution collects
+// per-line tokens. Compares a darray per line against a small array with inline storage.
+fn_internal void
+bench_small_array()
+{
+    file_io_read_result Result = platform_read_entire_file("input_p2.txt");
+    cassert(Result.Error == file_io_none);
+
+    char* Input    = Result.FileData;
+    u64   Length   = Result.FileSize;
+    s64 DarrayChecksum = 0;
+    s64 SmallChecksum  = 0;
+    f64 DarrayTime     = 0;
+    f64 SmallTime      = 0;
+
+    BenchTime(DarrayTime) ForRange(int, Repeat, BENCHMARK_REPEAT_COUNT)
+    {
+        s32* Digits = darray_init(s32);
+        ForRange(u64, i, Length)
+        {
+            if (is_digit(Input[i]))
+                darray_push(Digits, char_to_digit(Input[i]));
+
+            if (Input[i] == '\n' || i + 1 == Length)
+            {
+                u64 Count = darray_len(Digits);
+                ForRange(u64, j, Count)
+                    DarrayChecksum += Digits[j] * (s64)(j + 1);
+
+                darray_free(Digits);
+                Digits = darray_init(s32);
+            }
+        }
+        darray_free(Digits);
+    }
+    BenchTime(SmallTime) ForRange(int, Repeat, BENCHMARK_REPEAT_COUNT)
+    {
+        small_array_s32_16 Digits = {0};
+        ForRange(u64, i, Length)
+        {
+            if (is_digit(Input[i]))
+                small_array_s32_16_push(&Digits, char_to_digit(Input[i]));
+
+            if (Input[i] == '\n' || i + 1 == Length)
+            {
+                u64 Count = small_array_s32_16_len(&Digits);
+                ForRange(u64, j, Count)
+                    SmallChecksum += small_array_s32_16_get(&Digits, j) * (s64)(j + 1);
+
+                small_array_s32_16_free(&Digits);
+            }
+        }
+        small_array_s32_16_free(&Digits);
+    }
+
+    log_info("per-line digit lists (input_p2.txt x %d)", BENCHMARK_REPEAT_COUNT);
+    log_info("    darray:      %lf ms (checksum %ld)", DarrayTime, DarrayChecksum);
+    log_info("    small array: %lf ms (checksum %ld)", SmallTime,  SmallChecksum);
+    cassert(DarrayChecksum == SmallChecksum);
+
+    mem_free(Result.FileData);
+}
+
+#define BENCHMARK_HASH_COUNT 1000000
+
+// Naive separate chaining, the baseline for the hash map
+typedef struct chained_node
+{
+    struct chained_node* Next;
+    u64                  Key;
+    u64                  Value;
+} chained_node;
+
+typedef struct
+{
+    chained_node** Buckets;
+    u64            BucketMask;
+} chained_table;
+
+fn_internal void
+chained_table_put(chained_table* Table, u64 Key, u64 Value)
+{
+    chained_node** Bucket = &Table->Buckets[hash_u64(Key) & Table->BucketMask];
+    for (chained_node* Node = *Bucket; Node; Node = Node->Next)
+    {
+        if (Node->Key == Key) { Node->Value = Value; return; }
+    }
+
+    chained_node* Node = (chained_node*)malloc(sizeof(chained_node));
+    Node->Key   = Key;
+    Node->Value = Value;
+    Node->Next  = *Bucket;
+    *Bucket     = Node;
+}
+
+fn_internal u64*
+chained_table_get(chained_table* Table, u64 Key)
+{
+    for (chained_node* Node = Table->Buckets[hash_u64(Key) & Table->BucketMask]; Node; Node = Node->Next)
+    {
+        if (Node->Key == Key) return &Node->Value;
+    }
+    return NULL;
+}
+
+HASH_MAP_DEFINE_INT(u64, u64)
+HASH_MAP_DEFINE_STRING(u64, string)
+
+// Returns the next key after Key whose hash starts its probe at Group, in a table of GroupCount groups
+fn_internal u64
+check_hash_key_in_group(u64 Key, u64 Group, u64 GroupCount)
+{
+    do { ++Key; } while ((hash_u64(Key) & (GroupCount - 1)) != Group);
+    return Key;
+}
+
+fn_internal void
+check_hash_map_contents(hash_map_u64* Map, u64* Keys, u64 KeyCount)
+{
+    cassert(hash_map_u64_count(Map) == KeyCount);
+    ForRange(u64, i, KeyCount)
+    {
+        u64* Value = hash_map_u64_get(Map, Keys[i]);
+        cassert(Value && *Value == ~Keys[i]);
+    }
+
+    u64 Cursor  = 0;
+    u64 Visited = 0;
+    while (hash_map_u64_next(Map, &Cursor)) ++Visited;
+    cassert(Visited == KeyCount);
+}
+
+// Growth from the smallest table, remove and reinsert, and reusing slots in a group whose
+// overflow bits are set
+fn_internal void
+check_hash_map()
+{
+    u64  KeyCount = 10000;
+    u64* Keys     = mem_alloc(u64, KeyCount);
+    u64  State    = BENCHMARK_SEED;
+    ForRange(u64, i, KeyCount) Keys[i] = bench_random(&State);
+
+    // Heap and arena storage both have to survive growing from the minimum size
+    memory_arena Arena = arena_init(_MB(64));
+    ForRange(int, UseArena, 2)
+    {
+        hash_map_u64 Map;
+        hash_map_u64_init(&Map, UseArena ? &Arena : NULL, 0);
+        cassert(Map.Table.GroupCount == HASH_MIN_GROUP_COUNT);
+        cassert(hash_map_u64_get(&Map, Keys[0]) == NULL && !hash_map_u64_remove(&Map, Keys[0]));
+
+        ForRange(u64, i, KeyCount) hash_map_u64_put(&Map, Keys[i], ~Keys[i]);
+        cassert(Map.Table.GroupCount > HASH_MIN_GROUP_COUNT && Map.Table.Count <= Map.Table.MaxLoad);
+        check_hash_map_contents(&Map, Keys, KeyCount);
+
+        // Putting an existing key replaces the value without adding an entry
+        hash_map_u64_put(&Map, Keys[0], 1);
+        cassert(*hash_map_u64_get(&Map, Keys[0]) == 1 && hash_map_u64_count(&Map) == KeyCount);
+        hash_map_u64_put(&Map, Keys[0], ~Keys[0]);
+
+        // Remove every other key, the rest have to stay reachable past the emptied slots
+        for (u64 i = 1; i < KeyCount; i += 2)
+            cassert(hash_map_u64_remove(&Map, Keys[i]));
+        for (u64 i = 1; i < KeyCount; i += 2)
+            cassert(!hash_map_u64_remove(&Map, Keys[i]) && hash_map_u64_get(&Map, Keys[i]) == NULL);
+        for (u64 i = 0; i < KeyCount; i += 2)
+            cassert(*hash_map_u64_get(&Map, Keys[i]) == ~Keys[i]);
+        cassert(hash_map_u64_count(&Map) == KeyCount / 2);
+
+        for (u64 i = 1; i < KeyCount; i += 2)
+            hash_map_u64_put(&Map, Keys[i], ~Keys[i]);
+        check_hash_map_contents(&Map, Keys, KeyCount);
+
+        hash_map_u64_clear(&Map);
+        cassert(hash_map_u64_count(&Map) == 0 && hash_map_u64_get(&Map, Keys[0]) == NULL);
+        u64 Cursor = 0;
+        cassert(hash_map_u64_next(&Map, &Cursor) == NULL);
+
+        hash_map_u64_free(&Map);
+    }
+    arena_release(&Arena);
+
+    // Overflow one group of the smallest table: 15 keys fill group 0 and the 16th is pushed in
+    // to group 1, setting group 0's overflow bits.
+    hash_map_u64 Map;
+    hash_map_u64_init(&Map, NULL, 0);
+    u64 GroupKeys[HASH_GROUP_SLOTS + 1];
+    u64 Key = 0;
+    ForRange(u64, i, ArrayCount(GroupKeys))
+    {
+        Key = check_hash_key_in_group(Key, 0, HASH_MIN_GROUP_COUNT);
+        GroupKeys[i] = Key;
+        hash_map_u64_put(&Map, Key, ~Key);
+    }
+    cassert(Map.Table.GroupCount == HASH_MIN_GROUP_COUNT && Map.Table.Control[HASH_GROUP_SLOTS] != 0);
+    check_hash_map_contents(&Map, GroupKeys, ArrayCount(GroupKeys));
+
+    // Emptying a slot in the overflowed group keeps the overflow bits, so the key that was
+    // pushed out is still found, and costs a slot of max load until the next rehash
+    u64 MaxLoad = Map.Table.MaxLoad;
+    cassert(hash_map_u64_remove(&Map, GroupKeys[0]));
+    cassert(Map.Table.MaxLoad == MaxLoad - 1 && Map.Table.Control[HASH_GROUP_SLOTS] != 0);
+    cassert(*hash_map_u64_get(&Map, GroupKeys[HASH_GROUP_SLOTS]) == ~GroupKeys[HASH_GROUP_SLOTS]);
+
+    // A new key for the same group reuses the emptied slot
+    Key = check_hash_key_in_group(Key, 0, HASH_MIN_GROUP_COUNT);
+    GroupKeys[0] = Key;
+    hash_map_u64_put(&Map, Key, ~Key);
+    u64 Index = (u64)((u8*)hash_table_find_int(&Map.Table, Key) - Map.Table.Slots) / Map.Table.SlotSize;
+    cassert(Index < HASH_GROUP_SLOTS);
+    check_hash_map_contents(&Map, GroupKeys, ArrayCount(GroupKeys));
+
+    // Churning the group keeps lowering the max load until a rehash restores it
+    ForRange(u64, i, 64)
+    {
+        u64 Slot = i % ArrayCount(GroupKeys);
+        cassert(hash_map_u64_remove(&Map, GroupKeys[Slot]));
+        Key = check_hash_key_in_group(Key, 0, HASH_MIN_GROUP_COUNT);
+        GroupKeys[Slot] = Key;
+        hash_map_u64_put(&Map, Key, ~Key);
+        cassert(Map.Table.Count <= Map.Table.MaxLoad);
+        check_hash_map_contents(&Map, GroupKeys, ArrayCount(GroupKeys));
+    }
+    cassert(Map.Table.GroupCount <= 2 * HASH_MIN_GROUP_COUNT);
+    hash_map_u64_free(&Map);
+
+    // String keys compare the bytes, not the pointer
+    char Copy[] = "seven";
+    hash_map_string Strings;
+    hash_map_string_init(&Strings, NULL, 0);
+    hash_map_string_put(&Strings, "seven", 5, 7);
+    hash_map_string_put(&Strings, "", 0, 0);
+    cassert(*hash_map_string_get(&Strings, Copy, 5) == 7 && *hash_map_string_get(&Strings, "", 0) == 0);
+    cassert(hash_map_string_get(&Strings, "seve", 4) == NULL);
+    cassert(hash_map_string_remove(&Strings, Copy, 5) && !hash_map_string_remove(&Strings, "seven", 5));
+    cassert(hash_map_string_count(&Strings) == 1);
+    hash_map_string_free(&Strings);
+
+    mem_free(Keys);
+}
+
+// Inserts random keys, then looks up every key followed by as many keys that are not present.
+fn_internal void
+bench_hash_map()
+{
+    u64* Keys = mem_alloc(u64, BENCHMARK_HASH_COUNT * 2);
+    u64 State = BENCHMARK_SEED;
+    ForRange(u64, i, BENCHMARK_HASH_COUNT * 2) // The low bit splits the keys in to present and missing
+        Keys[i] = (bench_random(&State) & ~1ull) | (i >= BENCHMARK_HASH_COUNT);
+
+    s64 ChainedChecksum = 0;
+    s64 SwissChecksum   = 0;
+
+    chained_table Chained = {0};
+    Chained.BucketMask = next_highest_pow_2_u64(BENCHMARK_HASH_COUNT) - 1;
+    Chained.Buckets    = (chained_node**)calloc(Chained.BucketMask + 1, sizeof(chained_node*));
+
+    f64 ChainedInsertTime = 0;
+    f64 ChainedLookupTime = 0;
+    BenchTime(ChainedInsertTime) ForRange(u64, i, BENCHMARK_HASH_COUNT)
+        chained_table_put(&Chained, Keys[i], i);
+    BenchTime(ChainedLookupTime) ForRange(u64, i, BENCHMARK_HASH_COUNT * 2)
+    {
+        u64* Value = chained_table_get(&Chained, Keys[i]);
+        ChainedChecksum += Value ? (s64)*Value : -1;
+    }
+
+    memory_arena Arena = arena_init(_GB(1));
+    hash_map_u64 Swiss;
+    hash_map_u64_init(&Swiss, &Arena, BENCHMARK_HASH_COUNT); // Same as the chained table, sized up front
+
+    f64 SwissInsertTime = 0;
+    f64 SwissLookupTime = 0;
+    BenchTime(SwissInsertTime) ForRange(u64, i, BENCHMARK_HASH_COUNT)
+        hash_map_u64_put(&Swiss, Keys[i], i);
+    BenchTime(SwissLookupTime) ForRange(u64, i, BENCHMARK_HASH_COUNT * 2)
+    {
+        u64* Value = hash_map_u64_get(&Swiss, Keys[i]);
+        SwissChecksum += Value ? (s64)*Value : -1;
+    }
+
+    log_info("hash map (%d u64 keys, %d lookups, half missing)", BENCHMARK_HASH_COUNT, BENCHMARK_HASH_COUNT * 2);
+    log_info("    chained:  insert %lf ms, lookup %lf ms (checksum %ld)",
+            ChainedInsertTime, ChainedLookupTime, ChainedChecksum);
+    log_info("    hash_map: insert %lf ms, lookup %lf ms (checksum %ld)",
+            SwissInsertTime, SwissLookupTime, SwissChecksum);
+    cassert(ChainedChecksum == SwissChecksum);
+
+    ForRange(u64, i, Chained.BucketMask + 1)
+    {
+        chained_node* Node = Chained.Buckets[i];
+        while (Node)
+        {
+            chained_node* Next = Node->Next;
+            free(Node);
+            Node = Next;
+        }
+    }
+    free(Chained.Buckets);
+
+    hash_map_u64_free(&Swiss);
+    arena_release(&Arena);
+    mem_free(Keys);
+}
+
+#define BENCHMARK_HASH_BUFFER_SIZE _64MB
+#define BENCHMARK_HASH_CACHED_SIZE _KB(16)
+
+fn_internal u64
+fnv1a_hash(const void* Data, u64 Length)
+{
+    const u8* Bytes = (const u8*)Data;
+    u64 Hash = 0xcbf29ce484222325ull;
+    ForRange(u64, i, Length)
+    {
+        Hash ^= Bytes[i];
+        Hash *= 0x100000001b3ull;
+    }
+    return Hash;
+}
+
+typedef u64 hash_fn(const void* Data, u64 Length);
+
+fn_internal void
+bench_hash_fn(const char* Name, hash_fn* Fn, u8* Data, u64 Length, u32 Repeat)
+{
+    u64 Hash = 0;
+    f64 Time = 0;
+    // Repeats start a byte further along each time, hashing the same bytes would get hoisted
+    BenchTime(Time) ForRange(u32, i, Repeat) Hash += Fn(Data + i, Length);
+
+    f64 Bytes = (f64)Length * Repeat;
+    log_info("    %-12s %lf ms, %.2lf GB/s (hash %016lx)", Name, Time, (Bytes / _GB(1)) / (Time / 1000.0), Hash);
+}
+
+// Every length around the short, stripe and block boundaries, at an unaligned address, one shot
+// against streamed a byte at a time and in two pieces
+fn_internal void
+check_hash()
+{
+    u64 MaxLength = HASH_STRIPE_SIZE * HASH_STRIPES_PER_BLOCK + HASH_BUFFER_SIZE + 1;
+    u8* Buffer    = mem_alloc(u8, MaxLength + 1);
+    u8* Data      = Buffer + 1;
+    u64 State     = BENCHMARK_SEED;
+    ForRange(u64, i, MaxLength + 1) Buffer[i] = (u8)bench_random(&State);
+
+    hash_state Stream;
+    hash_state_init(&Stream);
+    cassert(hash_state_digest(&Stream) == hash_bytes(NULL, 0));
+    cassert(hash_bytes(Data, 0) == hash_bytes(NULL, 0) && hash_bytes_scalar(NULL, 0) == hash_bytes(NULL, 0));
+    hash_state_update(&Stream, Data, 0);
+    cassert(hash_state_digest(&Stream) == hash_bytes(NULL, 0));
+
+    file_io_read_result Missing = { .Error = file_io_file_not_found };
+    cassert(hash_file_result(&Missing) == hash_bytes(NULL, 0));
+
+    u64 Previous = hash_bytes(NULL, 0);
+    ForRange(u64, Length, MaxLength + 1)
+    {
+        u64 Hash = hash_bytes(Data, Length);
+        cassert(Hash == hash_bytes_scalar(Data, Length));
+        cassert(Length == 0 || Hash != Previous); // Catches a tail byte that isn't mixed in
+        Previous = Hash;
+
+        hash_state_init(&Stream);
+        ForRange(u64, i, Length)
+        {
+            hash_state_update(&Stream, Data + i, 1);
+            if (i == Length / 2) hash_state_digest(&Stream); // Digests leave the state alone
+        }
+        cassert(hash_state_digest(&Stream) == Hash);
+
+        u64 Split = (Length * 3) / 4;
+        hash_state_init(&Stream);
+        hash_state_update(&Stream, Data, Split);
+        hash_state_update(&Stream, Data + Split, Length - Split);
+        cassert(hash_state_digest(&Stream) == Hash);
+    }
+
+    mem_free(Buffer);
+}
+
+fn_internal void
+bench_hash()
+{
+    u8* Data = mem_alloc(u8, BENCHMARK_HASH_BUFFER_SIZE);
+    u64 State = BENCHMARK_SEED;
+    ForRange(u64, i, BENCHMARK_HASH_BUFFER_SIZE / 8)
+    {
+        u64 Value = bench_random(&State);
+        mem_copy(Data + i * 8, &Value, 8);
+    }
+
+    log_info("hash (%lu bytes)", BENCHMARK_HASH_BUFFER_SIZE);
+    bench_hash_fn("fnv-1a:",     fnv1a_hash,        Data, BENCHMARK_HASH_BUFFER_SIZE, 1);
+    bench_hash_fn("scalar:",     hash_bytes_scalar, Data, BENCHMARK_HASH_BUFFER_SIZE, 1);
+    bench_hash_fn("hash_bytes:", hash_bytes,        Data, BENCHMARK_HASH_BUFFER_SIZE, 1);
+
+    // The full buffer is bound by memory bandwidth, a slice that stays in cache shows the stripe loop
+    u32 CachedRepeat = (u32)(BENCHMARK_HASH_BUFFER_SIZE / BENCHMARK_HASH_CACHED_SIZE);
+    log_info("hash (%lu bytes x %u, in cache)", BENCHMARK_HASH_CACHED_SIZE, CachedRepeat);
+    bench_hash_fn("scalar:",     hash_bytes_scalar, Data, BENCHMARK_HASH_CACHED_SIZE, CachedRepeat);
+    bench_hash_fn("hash_bytes:", hash_bytes,        Data, BENCHMARK_HASH_CACHED_SIZE, CachedRepeat);
+    cassert(hash_bytes_scalar(Data, BENCHMARK_HASH_BUFFER_SIZE) == hash_bytes(Data, BENCHMARK_HASH_BUFFER_SIZE));
+
+    // Streaming in uneven chunks has to match the one shot hash
+    hash_state Stream;
+    hash_state_init(&Stream);
+    for (u64 Offset = 0; Offset < BENCHMARK_HASH_BUFFER_SIZE;)
+    {
+        u64 Chunk = (Offset % 7919) + 1;
+        if (Chunk > BENCHMARK_HASH_BUFFER_SIZE - Offset) Chunk = BENCHMARK_HASH_BUFFER_SIZE - Offset;
+        hash_state_update(&Stream, Data + Offset, Chunk);
+        Offset += Chunk;
+    }
+    cassert(hash_state_digest(&Stream) == hash_bytes(Data, BENCHMARK_HASH_BUFFER_SIZE));
+
+    file_io_read_result Input = platform_read_entire_file("input_p2.txt");
+    log_info("    input_p2.txt hash %016lx", hash_file_result(&Input));
+    mem_free(Input.FileData);
+
+    mem_free(Data);
+}
+
+#define BENCHMARK_PARSE_COUNT 1000000
+
+// Numbers are separated by a null terminator, sscanf calls strlen on the whole string it is
+// given and would go quadratic on one long buffer
+fn_internal char*
+bench_parse_build_input(bool Floats, u64* OutLength)
+{
+    u64   Capacity = BENCHMARK_PARSE_COUNT * 32;
+    char* Input    = mem_alloc(char, Capacity);
+    u64   Length   = 0;
+
+    u64 State = BENCHMARK_SEED;
+    ForRange(u64, i, BENCHMARK_PARSE_COUNT)
+    {
+        bench_random(&State);
+        s64 Value = (s64)(State >> (State & 31)) * ((State & 32) ? -1 : 1);
+
+        if (Floats) Length += snprintf(Input + Length, Capacity - Length, "%ld.%03ld", Value % 10000000, (s64)(State % 1000));
+        else        Length += snprintf(Input + Length, Capacity - Length, "%ld", Value);
+        Length += 1; // Past the terminator
+    }
+
+    *OutLength = Length;
+    return Input;
+}
+
+typedef struct
+{
+    const char*        Text;
+    parse_number_error Error;
+    s64                Value;
+    u64                Consumed;
+} check_parse_case;
+
+// Empty and sign-only views, the edges of the s64 and u64 ranges, views that end in the middle
+// of an 8 digit chunk, and float forms the fast path hands to strtod
+fn_internal void
+check_parse()
+{
+    const check_parse_case IntCases[] = {
+        { "",                      parse_number_invalid,  0,            0 },
+        { "-",                     parse_number_invalid,  0,            0 },
+        { "+x",                    parse_number_invalid,  0,            0 },
+        { "0",                     parse_number_ok,       0,            1 },
+        { "-0",                    parse_number_ok,       0,            2 },
+        { "+42,",                  parse_number_ok,       42,           3 },
+        { "00000000000000000000000000000042", parse_number_ok, 42, 32 },
+        { "9223372036854775807",   parse_number_ok,       I64_MAX,      19 },
+        { "-9223372036854775808",  parse_number_ok,       INT64_MIN,    20 },
+        { "9223372036854775808",   parse_number_overflow, 0,            0 },
+        { "-9223372036854775809",  parse_number_overflow, 0,            0 },
+        { "18446744073709551616",  parse_number_overflow, 0,            0 }, // Wraps to 0 in a u64
+        { "99999999999999999999",  parse_number_overflow, 0,            0 },
+        { "123456789012345678901", parse_number_overflow, 0,            0 },
+    };
+    ForRange(u64, i, ArrayCount(IntCases))
+    {
+        const check_parse_case* Case = &IntCases[i];
+        s64 Value    = -1;
+        u64 Consumed = U64_MAX;
+        parse_number_error Error = str_view_parse_s64(str_view_make(Case->Text, string_len(Case->Text)), &Value, &Consumed);
+        cassert(Error == Case->Error && Value == Case->Value && Consumed == Case->Consumed);
+    }
+
+    u64 Unsigned = 0;
+    u64 Consumed = 0;
+    cassert(str_view_parse_u64(str_view_make("18446744073709551615", 20), &Unsigned, &Consumed) == parse_number_ok);
+    cassert(Unsigned == U64_MAX && Consumed == 20);
+    cassert(str_view_parse_u64(str_view_make("18446744073709551616", 20), &Unsigned, &Consumed) == parse_number_overflow);
+    cassert(str_view_parse_u64(str_view_make("-1", 2), &Unsigned, &Consumed) == parse_number_invalid);
+
+    // Every prefix of a run of digits: the view has to stop the parse even where the bytes
+    // behind it are digits too
+    const char* Digits = "12345678901234567890";
+    s64 Expected = 0;
+    for (u64 Length = 1; Length <= 18; ++Length)
+    {
+        Expected = Expected * 10 + (Digits[Length - 1] - '0');
+        s64 Value = 0;
+        cassert(str_view_parse_s64(str_view_make(Digits, Length), &Value, &Consumed) == parse_number_ok);
+        cassert(Value == Expected && Consumed == Length);
+    }
+
+    // Floats, the exact fast path against strtod
+    const char* Floats[] = {
+        "0", "-0.0", "1.5", ".5", "5.", "1e3", "1E+3", "2.5e-3", "123456789.987654321",
+        "9007199254740993", "1e22", "1e23", "1e-400", "4.9e-324", "1.7976931348623157e308",
+        "12345678901234567890123.5", "0.000000000000000000000000000001",
+    };
+    ForRange(u64, i, ArrayCount(Floats))
+    {
+        f64 Value = 0;
+        cassert(str_view_parse_f64(str_view_make(Floats[i], string_len(Floats[i])), &Value, &Consumed) == parse_number_ok);
+        cassert(Value == strtod(Floats[i], NULL) && Consumed == string_len(Floats[i]));
+    }
+
+    f64 Value = 0;
+    cassert(str_view_parse_f64(str_view_make("1e", 2), &Value, &Consumed) == parse_number_ok && Value == 1 && Consumed == 1);
+    cassert(str_view_parse_f64(str_view_make("2.5e+", 5), &Value, &Consumed) == parse_number_ok && Consumed == 3);
+    cassert(str_view_parse_f64(str_view_make("1.5", 2), &Value, &Consumed) == parse_number_ok && Value == 1 && Consumed == 2);
+    cassert(str_view_parse_f64(str_view_make(".", 1),   &Value, &Consumed) == parse_number_invalid);
+    cassert(str_view_parse_f64(str_view_make("-", 1),   &Value, &Consumed) == parse_number_invalid);
+    cassert(str_view_parse_f64(str_view_make("", 0),    &Value, &Consumed) == parse_number_invalid);
+    cassert(str_view_parse_f64(str_view_make("1e400", 5), &Value, &Consumed) == parse_number_overflow);
+    cassert(str_view_parse_f64(str_view_make("-inf", 4), &Value, &Consumed) == parse_number_ok && Value < F64_MIN);
+
+    f32 Single = 0;
+    cassert(str_view_parse_f32(str_view_make("0.1", 3), &Single, &Consumed) == parse_number_ok && Single == 0.1f);
+    cassert(str_view_parse_f32(str_view_make("16777217", 8), &Single, &Consumed) == parse_number_ok && Single == strtof("16777217", NULL));
+    cassert(str_view_parse_f32(str_view_make("1e39", 4), &Single, &Consumed) == parse_number_overflow);
+}
+
+fn_internal void
+bench_parse()
+{
+    u64   IntLength   = 0;
+    u64   FloatLength = 0;
+    char* Ints        = bench_parse_build_input(false, &IntLength);
+    char* Floats      = bench_parse_build_input(true,  &FloatLength);
+
+    log_info("number parsing (%d numbers)", BENCHMARK_PARSE_COUNT);
+
+    // sscanf
+    u64 ScanIntSum = 0; // Unsigned so the sums can wrap
+    f64 ScanFloatSum = 0;
+    f64 ScanIntTime = 0;
+    char* Cursor = Ints;
+    BenchTime(ScanIntTime) ForRange(u64, i, BENCHMARK_PARSE_COUNT)
+    {
+        long long Value = 0;
+        int Consumed = 0;
+        if (sscanf(Cursor, "%lld%n", &Value, &Consumed) != 1) break;
+        ScanIntSum += (u64)Value;
+        Cursor     += Consumed + 1;
+    }
+
+    f64 ScanFloatTime = 0;
+    Cursor = Floats;
+    BenchTime(ScanFloatTime) ForRange(u64, i, BENCHMARK_PARSE_COUNT)
+    {
+        f64 Value = 0;
+        int Consumed = 0;
+        if (sscanf(Cursor, "%lf%n", &Value, &Consumed) != 1) break;
+        ScanFloatSum += Value;
+        Cursor       += Consumed + 1;
+    }
+
+    // str_view parsers
+    u64 ParseIntSum = 0;
+    f64 ParseFloatSum = 0;
+    f64 ParseIntTime  = 0;
+    BenchTime(ParseIntTime) for (str_view View = str_view_make(Ints, IntLength); View.Length;)
+    {
+        s64 Value    = 0;
+        u64 Consumed = 0;
+        if (str_view_parse_s64(View, &Value, &Consumed) != parse_number_ok) break;
+        ParseIntSum += (u64)Value;
+        View         = str_view_skip(View, Consumed + 1);
+    }
+
+    f64 ParseFloatTime = 0;
+    BenchTime(ParseFloatTime) for (str_view View = str_view_make(Floats, FloatLength); View.Length;)
+    {
+        f64 Value    = 0;
+        u64 Consumed = 0;
+        if (str_view_parse_f64(View, &Value, &Consumed) != parse_number_ok) break;
+        ParseFloatSum += Value;
+        View           = str_view_skip(View, Consumed + 1);
+    }
+
+    log_info("    sscanf s64:   %lf ms (checksum %lu)", ScanIntTime,  ScanIntSum);
+    log_info("    parse s64:    %lf ms (checksum %lu)", ParseIntTime, ParseIntSum);
+    log_info("    sscanf f64:   %lf ms (checksum %lf)", ScanFloatTime,  ScanFloatSum);
+    log_info("    parse f64:    %lf ms (checksum %lf)", ParseFloatTime, ParseFloatSum);
+    cassert(ScanIntSum == ParseIntSum && ScanFloatSum == ParseFloatSum);
+
+    mem_free(Ints);
+    mem_free(Floats);
+}
+
+#define BENCHMARK_EXTRACT_LINES 200000
+
+// Lines of 1 to 8 integers, separated by spaces or commas
+fn_internal char*
+bench_extract_build_input(u64* OutLength)
+{
+    u64   Capacity = BENCHMARK_EXTRACT_LINES * 8 * 16;
+    char* Input    = mem_alloc(char, Capacity);
+    u64   Length   = 0;
+
+    u64 State = BENCHMARK_SEED;
+    ForRange(u64, Line, BENCHMARK_EXTRACT_LINES)
+    {
+        u64 Count = 1 + (bench_random(&State) & 7);
+        ForRange(u64, i, Count)
+        {
+            bench_random(&State);
+            s64 Value = (s64)(State >> (40 + (State & 15))) * ((State & 16) ? -1 : 1);
+            Length += snprintf(Input + Length, Capacity - Length, (i + 1 < Count) ? ((State & 32) ? "%ld, " : "%ld ") : "%ld\n", Value);
+        }
+    }
+
+    *OutLength = Length;
+    return Input;
+}
+
+// Byte at a time version of str_view_extract_integers, writes every value and line offset
+fn_internal integer_extract_result
+check_extract_reference(str_view Text, s64* OutValues, u64* OutLineOffsets)
+{
+    integer_extract_result Result = { 0, 1 };
+    OutLineOffsets[0] = 0;
+
+    for (u64 i = 0; i < Text.Length; ++i)
+    {
+        char Byte = Text.Data[i];
+        if (Byte == '\n' && i + 1 < Text.Length)
+            OutLineOffsets[Result.LineCount++] = Result.ValueCount;
+
+        if (!is_digit(Byte) || (i > 0 && is_digit(Text.Data[i - 1]))) continue;
+
+        bool Negative = i > 0 && Text.Data[i - 1] == '-' && (i == 1 || !is_digit(Text.Data[i - 2]));
+        u64  Value    = 0;
+        for (u64 j = i; j < Text.Length && is_digit(Text.Data[j]); ++j)
+            Value = Value * 10 + (u64)(Text.Data[j] - '0');
+
+        OutValues[Result.ValueCount++] = Negative ? (s64)(0 - Value) : (s64)Value;
+    }
+
+    OutLineOffsets[Result.LineCount] = Result.ValueCount;
+    return Result;
+}
+
+// Empty text, text without numbers, trailing newlines, and random text of every length up to a
+// few scan widths at an odd address, so numbers and lines straddle the 32 byte chunks and the tail
+fn_internal void
+check_extract()
+{
+    const char* Alphabet = "0123456789999--\n\n ,x";
+    u64   MaxLength = 200;
+    char* Buffer    = mem_alloc(char, MaxLength + 1);
+    s64*  Expected  = mem_alloc(s64, MaxLength);
+    u64*  ExpectedLines = mem_alloc(u64, MaxLength + 2);
+    s64*  Values    = mem_alloc(s64, MaxLength + 1);
+    u64*  Lines     = mem_alloc(u64, MaxLength + 2);
+    u64   State     = BENCHMARK_SEED;
+
+    const char* Fixed[] = {
+        "", "\n", "\n\n", "abc", "-", "--5", "3-5", "-3-5\n", "7\n", "\n7", "1\n\n2\n",
+        "12345678901234567890123456789012345678901234567890", // Longer than a chunk, wraps
+    };
+
+    ForRange(u64, Round, ArrayCount(Fixed) + MaxLength + 1)
+    {
+        char* Text   = Buffer + 1;
+        u64   Length = 0;
+        if (Round < ArrayCount(Fixed))
+        {
+            Length = string_len(Fixed[Round]);
+            mem_copy(Text, Fixed[Round], Length);
+        }
+        else
+        {
+            Length = Round - ArrayCount(Fixed);
+            ForRange(u64, i, Length) Text[i] = Alphabet[bench_random(&State) % string_len(Alphabet)];
+        }
+        str_view View = str_view_make(Text, Length);
+
+        integer_extract_result Reference = check_extract_reference(View, Expected, ExpectedLines);
+        integer_extract_result Counts    = str_view_count_integers(View);
+        cassert(Counts.ValueCount == Reference.ValueCount && Counts.LineCount == Reference.LineCount);
+
+        integer_extract_result Result = str_view_extract_integers(View, Values, MaxLength, Lines, MaxLength + 2);
+        cassert(Result.ValueCount == Reference.ValueCount && Result.LineCount == Reference.LineCount);
+        ForRange(u64, i, Result.ValueCount)     cassert(Values[i] == Expected[i]);
+        ForRange(u64, i, Result.LineCount + 1) cassert(Lines[i] == ExpectedLines[i]);
+
+        // Short outputs get the first values and still report the totals
+        u64 Capacity = Reference.ValueCount / 2;
+        Values[Capacity] = 0x5A5A;
+        Lines[1]         = 0x5A5A;
+        Result = str_view_extract_integers(View, Values, Capacity, Lines, 1);
+        cassert(Result.ValueCount == Reference.ValueCount && Result.LineCount == Reference.LineCount);
+        cassert(Values[Capacity] == 0x5A5A && Lines[1] == 0x5A5A && Lines[0] == 0);
+        ForRange(u64, i, Capacity) cassert(Values[i] == Expected[i]);
+
+        // Appending after existing values shifts the line offsets, and the offsets are optional
+        darray_s64 Array   = {0};
+        darray_u64 Offsets = {0};
+        darray_s64_push(&Array, -1);
+        darray_extract_integers(View, &Array, &Offsets);
+        cassert(Array.Length == Reference.ValueCount + 1 && Offsets.Length == Reference.LineCount + 1);
+        ForRange(u64, i, Reference.ValueCount)     cassert(Array.Data[i + 1] == Expected[i]);
+        ForRange(u64, i, Reference.LineCount + 1) cassert(Offsets.Data[i] == ExpectedLines[i] + 1);
+
+        darray_extract_integers(View, &Array, NULL);
+        cassert(Array.Length == 2 * Reference.ValueCount + 1);
+        darray_s64_free(&Array);
+        darray_u64_free(&Offsets);
+    }
+
+    mem_free(Buffer);
+    mem_free(Expected);
+    mem_free(ExpectedLines);
+    mem_free(Values);
+    mem_free(Lines);
+}
+
+fn_internal void
+bench_extract()
+{
+    u64   Length = 0;
+    char* Input  = bench_extract_build_input(&Length);
+
+    log_info("integer extraction (%d lines, %lu bytes)", BENCHMARK_EXTRACT_LINES, Length);
+
+    // Token at a time: skip to the next digit or sign, then parse and push
+    darray_s64 Tokens = {0};
+    f64 TokenTime = 0;
+    BenchTime(TokenTime) for (str_view View = str_view_make(Input, Length); View.Length;)
+    {
+        char First = View.Data[0];
+        if (First != '-' && (First < '0' || First > '9'))
+        {
+            View = str_view_skip(View, 1);
+            continue;
+        }
+
+        s64 Value    = 0;
+        u64 Consumed = 0;
+        if (str_view_parse_s64(View, &Value, &Consumed) != parse_number_ok)
+            Consumed = 1;
+        else
+            darray_s64_push(&Tokens, Value);
+        View = str_view_skip(View, Consumed);
+    }
+
+    darray_s64 Values      = {0};
+    darray_u64 LineOffsets = {0};
+    f64        BulkTime    = 0;
+    BenchTime(BulkTime) darray_extract_integers(str_view_make(Input, Length), &Values, &LineOffsets);
+
+    u64 TokenSum = 0;
+    u64 BulkSum  = 0;
+    ForRange(u64, i, Tokens.Length) TokenSum += (u64)Tokens.Data[i];
+    ForRange(u64, i, Values.Length) BulkSum  += (u64)Values.Data[i];
+
+    log_info("    per token: %lf ms (%lu values, checksum %lu)", TokenTime, Tokens.Length, TokenSum);
+    log_info("    bulk:      %lf ms (%lu values, checksum %lu)", BulkTime,  Values.Length, BulkSum);
+    cassert(Tokens.Length == Values.Length && TokenSum == BulkSum);
+    cassert(LineOffsets.Length == BENCHMARK_EXTRACT_LINES + 1);
+
+    darray_s64_free(&Tokens);
+    darray_s64_free(&Values);
+    darray_u64_free(&LineOffsets);
+    mem_free(Input);
+}
+
+#define BENCHMARK_MEMORY_MAX   _64MB
+#define BENCHMARK_MEMORY_TOTAL _256MB // Bytes processed per size, small sizes repeat more
+
+typedef void memory_set_fn(void* Memory, u8 Value, u64 Size);
+typedef void memory_copy_fn(void* Destination, const void* Source, u64 Size);
+typedef bool memory_equal_fn(const void* Left, const void* Right, u64 Size);
+
+fn_internal void libc_memory_set(void* Memory, u8 Value, u64 Size)                  { memset(Memory, Value, Size); }
+fn_internal void libc_memory_copy(void* Destination, const void* Source, u64 Size) { memcpy(Destination, Source, Size); }
+fn_internal bool libc_memory_equal(const void* Left, const void* Right, u64 Size)  { return memcmp(Left, Right, Size) == 0; }
+
+fn_internal f64
+bench_memory_gbps(u64 Size, f64 Time)
+{
+    u64 Count = BENCHMARK_MEMORY_TOTAL / Size;
+    return ((f64)(Count * Size) / _GB(1)) / (Time / 1000.0);
+}
+
+// The volatile function pointers keep the compiler from inlining the calls and then merging or
+// hoisting them out of the loop
+fn_internal f64
+bench_memory_set(memory_set_fn* volatile Fn, u8* Memory, u64 Size)
+{
+    u64 Count = BENCHMARK_MEMORY_TOTAL / Size;
+    f64 Time  = 0;
+    BenchTime(Time) ForRange(u64, i, Count)
+        Fn(Memory, (u8)i, Size);
+    return bench_memory_gbps(Size, Time);
+}
+
+fn_internal f64
+bench_memory_copy(memory_copy_fn* volatile Fn, u8* Destination, u8* Source, u64 Size)
+{
+    u64 Count = BENCHMARK_MEMORY_TOTAL / Size;
+    f64 Time  = 0;
+    BenchTime(Time) ForRange(u64, i, Count)
+        Fn(Destination, Source, Size);
+    return bench_memory_gbps(Size, Time);
+}
+
+fn_internal f64
+bench_memory_equal(memory_equal_fn* volatile Fn, u8* Left, u8* Right, u64 Size, u64* OutEqualCount)
+{
+    u64 Count = BENCHMARK_MEMORY_TOTAL / Size;
+    u64 Equal = 0;
+    f64 Time  = 0;
+    BenchTime(Time) ForRange(u64, i, Count)
+        Equal += Fn(Left, Right, Size);
+
+    *OutEqualCount = Equal;
+    return bench_memory_gbps(Size, Time);
+}
+
+#define CHECK_MEMORY_GUARD 64
+
+// One size at one pair of offsets. Buffers have CHECK_MEMORY_GUARD bytes on both sides of the
+// range, which must come through untouched.
+fn_internal void
+check_memory_range(u8* Left, u8* Right, u8* Source, u64 LeftOffset, u64 RightOffset, u64 Size)
+{
+    u64 Total = Size + 2 * CHECK_MEMORY_GUARD + 32;
+    memset(Left,  0xEE, Total);
+    memset(Right, 0xEE, Total);
+    u8* Destination = Left  + CHECK_MEMORY_GUARD + LeftOffset;
+    u8* Other       = Right + CHECK_MEMORY_GUARD + RightOffset;
+
+    memory_set(Destination, 0x5A, Size);
+    ForRange(u64, i, Total)
+    {
+        bool Inside = Left + i >= Destination && Left + i < Destination + Size;
+        cassert(Left[i] == (Inside ? 0x5A : 0xEE));
+    }
+
+    memory_copy(Destination, Source + RightOffset, Size);
+    memory_copy(Other,       Source + RightOffset, Size);
+    cassert(memcmp(Destination, Source + RightOffset, Size) == 0);
+    cassert(memcmp(Left,  Right, CHECK_MEMORY_GUARD) == 0 && Destination[-1] == 0xEE && Destination[Size] == 0xEE);
+    cassert(Other[-1] == 0xEE && Other[Size] == 0xEE);
+
+    // Equal at different alignments, then a difference at the first, middle and last byte
+    cassert(memory_equal(Destination, Other, Size));
+    if (Size == 0)
+    {
+        cassert(memory_equal(Left, Source, 0));
+        return;
+    }
+
+    u64 Positions[] = { 0, Size / 2, Size - 1 };
+    ForRange(u32, i, ArrayCount(Positions))
+    {
+        Other[Positions[i]] ^= 0x80;
+        cassert(!memory_equal(Destination, Other, Size) && !memory_equal(Other, Destination, Size));
+        Other[Positions[i]] ^= 0x80;
+    }
+}
+
+// Every size up to a few vector widths at every destination alignment, which covers the inline
+// size classes, and sizes around the streaming store threshold
+fn_internal void
+check_memory()
+{
+    u64 MaxSize = MEMORY_NON_TEMPORAL_THRESHOLD + 257;
+    u64 Total   = MaxSize + 2 * CHECK_MEMORY_GUARD + 32;
+    u8* Left    = mem_alloc(u8, Total);
+    u8* Right   = mem_alloc(u8, Total);
+    u8* Source  = mem_alloc(u8, MaxSize + 32);
+    u64 State   = BENCHMARK_SEED;
+    ForRange(u64, i, MaxSize + 32) Source[i] = (u8)bench_random(&State);
+
+    ForRange(u64, Size, 300)
+    {
+        ForRange(u64, Offset, 32)
+            check_memory_range(Left, Right, Source, Offset, (Offset * 7) & 31, Size);
+    }
+
+    const u64 Sizes[] = {
+        511, 512, 513, 1000, _KB(4) - 1, _KB(4), _KB(4) + 33,
+        MEMORY_NON_TEMPORAL_THRESHOLD - 1, MEMORY_NON_TEMPORAL_THRESHOLD, MEMORY_NON_TEMPORAL_THRESHOLD + 257,
+    };
+    ForRange(u32, i, ArrayCount(Sizes))
+    {
+        check_memory_range(Left, Right, Source, 0,  0,  Sizes[i]);
+        check_memory_range(Left, Right, Source, 1,  30, Sizes[i]);
+        check_memory_range(Left, Right, Source, 31, 5,  Sizes[i]);
+    }
+
+    mem_free(Left);
+    mem_free(Right);
+    mem_free(Source);
+}
+
+fn_internal void
+bench_memory()
+{
+    // Right sits half a page off from Left. When the copy's loads and stores share a page
+    // offset the loads falsely wait on the stores (4K aliasing).
+    u8* Left      = mem_alloc(u8, BENCHMARK_MEMORY_MAX);
+    u8* RightBase = mem_alloc(u8, BENCHMARK_MEMORY_MAX + _KB(2));
+    u8* Right     = RightBase + _KB(2);
+    memset(Left,      1, BENCHMARK_MEMORY_MAX); // Fault the pages in up front
+    memset(RightBase, 1, BENCHMARK_MEMORY_MAX + _KB(2));
+
+    const u64 Sizes[] = { 8, 64, 128, 256, 512, _KB(4), _KB(32), _KB(256), _MB(2), _16MB, _64MB };
+
+    log_info("memory primitives, GB/s (libc / chibi)");
+    ForRange(u32, SizeIndex, ArrayCount(Sizes))
+    {
+        u64 Size = Sizes[SizeIndex];
+        f64 LibcSet  = bench_memory_set(libc_memory_set, Left, Size);
+        f64 ChibiSet = bench_memory_set(memory_set,      Left, Size);
+
+        f64 LibcCopy  = bench_memory_copy(libc_memory_copy, Right, Left, Size);
+        f64 ChibiCopy = bench_memory_copy(memory_copy,      Right, Left, Size);
+
+        // The copy left both sides equal, so every compare reads the whole range
+        u64 LibcEqual  = 0;
+        u64 ChibiEqual = 0;
+        f64 LibcCmp  = bench_memory_equal(libc_memory_equal, Left, Right, Size, &LibcEqual);
+        f64 ChibiCmp = bench_memory_equal(memory_equal,      Left, Right, Size, &ChibiEqual);
+        cassert(LibcEqual == ChibiEqual && LibcEqual == BENCHMARK_MEMORY_TOTAL / Size);
+
+        log_info("    %9lu bytes: set %6.2lf / %6.2lf, copy %6.2lf / %6.2lf, equal %6.2lf / %6.2lf",
+                 Size, LibcSet, ChibiSet, LibcCopy, ChibiCopy, LibcCmp, ChibiCmp);
+    }
+
+    mem_free(Left);
+    mem_free(RightBase);
+}
+
+#define BENCHMARK_SEARCH_SIZE _16MB
+
+// The old get_line scan, a byte at a time until the line end
+fn_internal u64
+bench_count_lines_scalar(const char* Text, u64 Length)
+{
+    u64 Lines = 0;
+    for (const char* Iter = Text, *End = Text + Length; Iter < End; ++Iter, ++Lines)
+    {
+        while (Iter < End && !is_line_end(*Iter)) Iter++;
+        if (Iter == End) break;
+    }
+    return Lines;
+}
+
+fn_internal u64
+bench_count_lines_simd(const char* Text, u64 Length)
+{
+    u64 Lines = 0;
+    for (const char* Iter = Text, *End = Text + Length; Iter < End; ++Iter, ++Lines)
+    {
+        Iter = string_find_either_byte(Iter, End - Iter, '\r', '\n');
+        if (!Iter) break;
+    }
+    return Lines;
+}
+
+#define CHECK_SEARCH_MAX_LENGTH 160
+
+fn_internal const char*
+check_find_reference(const char* String, u64 Length, const char* Needle, u64 NeedleLength)
+{
+    for (u64 Start = 0; Start + NeedleLength <= Length; ++Start)
+    {
+        if (memcmp(String + Start, Needle, NeedleLength) == 0) return String + Start;
+    }
+    return NULL;
+}
+
+// Searches of every length up to a few vector widths, with the text ending right against an
+// inaccessible page so any read past the end faults. The text is mostly 'a' and 'b' so partial
+// matches of the needle are everywhere.
+fn_internal void
+check_string_search()
+{
+    u64 PageSize = platform_get_page_size();
+    u8* Pages    = (u8*)platform_virtual_reserve_memory(2 * PageSize);
+    cassert(Pages);
+    platform_virtual_map_to_physical(Pages, 0, PageSize); // The second page stays inaccessible
+
+    u64 State = BENCHMARK_SEED;
+    ForRange(u64, Length, CHECK_SEARCH_MAX_LENGTH + 1)
+    {
+        char* Text = (char*)Pages + PageSize - Length;
+        ForRange(u64, i, Length) Text[i] = "aab\n"[bench_random(&State) & 3];
+
+        // Bytes that are missing, first, last and only at the very end
+        cassert(string_find_byte(Text, Length, '#') == NULL);
+        cassert(string_find_byte(Text, Length, 'b')         == memchr(Text, 'b', Length));
+        cassert(string_find_either_byte(Text, Length, '#', '%') == NULL);
+        const char* Newline = memchr(Text, '\n', Length);
+        const char* Either  = memchr(Text, 'b', Length);
+        if (!Either || (Newline && Newline < Either)) Either = Newline;
+        cassert(string_find_either_byte(Text, Length, 'b', '\n') == Either);
+        if (Length)
+        {
+            char Saved = Text[Length - 1];
+            Text[Length - 1] = '#';
+            cassert(string_find_byte(Text, Length, '#') == Text + Length - 1);
+            cassert(string_find_either_byte(Text, Length, '%', '#') == Text + Length - 1);
+            Text[Length - 1] = Saved;
+        }
+
+        // Needles taken from the text, including one that is the whole text and one at the end,
+        // plus random needles that mostly miss
+        for (u64 NeedleLength = 0; NeedleLength <= Length + 1 && NeedleLength <= 40; ++NeedleLength)
+        {
+            char Needle[41];
+            ForRange(u64, i, NeedleLength) Needle[i] = "ab"[bench_random(&State) & 1];
+            cassert(string_find(Text, Length, Needle, NeedleLength) == check_find_reference(Text, Length, Needle, NeedleLength));
+
+            if (NeedleLength <= Length)
+            {
+                const char* Tail = Text + Length - NeedleLength;
+                cassert(string_find(Text, Length, Tail, NeedleLength) == check_find_reference(Text, Length, Tail, NeedleLength));
+                cassert(string_find(Text, Length, Text, NeedleLength) == Text);
+            }
+        }
+
+        // A needle longer than the text never matches, even when the text is its prefix
+        char Longer[CHECK_SEARCH_MAX_LENGTH + 1];
+        mem_copy(Longer, Text, Length);
+        Longer[Length] = 'a';
+        cassert(string_find(Text, Length, Longer, Length + 1) == NULL);
+        cassert(string_compare(Text, Length, Text, Length));
+        if (Length) cassert(!string_compare(Text, Length, Text, Length - 1));
+    }
+
+    char Prefix[] = "abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz";
+    u64  PrefixLength = string_len(Prefix);
+    cassert(string_find(Prefix, 10, Prefix, 11) == NULL);
+    cassert(string_find(Prefix, PrefixLength - 1, Prefix, PrefixLength) == NULL);
+    cassert(string_find(Prefix, 0, "", 0) == Prefix);
+    cassert(string_find(Prefix, PrefixLength, "9a", 2) == Prefix + 35);
+
+    platform_virtual_free(Pages, 2 * PageSize);
+}
+
+fn_internal void
+bench_string_search()
+{
+    // Lower case lines of 16 to 79 letters
+    char* Text  = mem_alloc(char, BENCHMARK_SEARCH_SIZE);
+    u64   State = BENCHMARK_SEED;
+    for (u64 i = 0; i < BENCHMARK_SEARCH_SIZE;)
+    {
+        u64 LineLength = 16 + (bench_random(&State) & 63);
+        for (u64 j = 0; j < LineLength && i < BENCHMARK_SEARCH_SIZE; ++j, ++i)
+            Text[i] = 'a' + (char)(bench_random(&State) % 26);
+        if (i < BENCHMARK_SEARCH_SIZE) Text[i++] = '\n';
+    }
+
+    log_info("string search (%lu bytes)", BENCHMARK_SEARCH_SIZE);
+
+    u64 ScalarLines    = 0;
+    u64 SimdLines      = 0;
+    f64 ScalarLineTime = 0;
+    f64 SimdLineTime   = 0;
+    BenchTime(ScalarLineTime) ScalarLines = bench_count_lines_scalar(Text, BENCHMARK_SEARCH_SIZE);
+    BenchTime(SimdLineTime)   SimdLines   = bench_count_lines_simd(Text, BENCHMARK_SEARCH_SIZE);
+
+    log_info("    line ends, scalar:      %lf ms (%lu lines)", ScalarLineTime, ScalarLines);
+    log_info("    line ends, either_byte: %lf ms (%lu lines)", SimdLineTime,   SimdLines);
+    cassert(ScalarLines == SimdLines);
+
+    // A byte that isn't in the text scans the whole buffer
+    const char* LibcByte     = NULL;
+    const char* FindByte     = NULL;
+    f64         LibcByteTime = 0;
+    f64         FindByteTime = 0;
+    BenchTime(LibcByteTime) LibcByte = memchr(Text, '#', BENCHMARK_SEARCH_SIZE);
+    BenchTime(FindByteTime) FindByte = string_find_byte(Text, BENCHMARK_SEARCH_SIZE, '#');
+
+    log_info("    byte, memchr:           %lf ms", LibcByteTime);
+    log_info("    byte, string_find_byte: %lf ms", FindByteTime);
+    cassert(LibcByte == NULL && FindByte == NULL);
+
+    // Substring, planted once at the very end
+    const char* Needle       = "sevenineightwo";
+    u64         NeedleLength = string_len(Needle);
+    mem_copy(Text + BENCHMARK_SEARCH_SIZE - NeedleLength, Needle, NeedleLength);
+
+    const char* LibcFind     = NULL;
+    const char* Find         = NULL;
+    f64         LibcFindTime = 0;
+    f64         FindTime     = 0;
+    BenchTime(LibcFindTime) LibcFind = memmem(Text, BENCHMARK_SEARCH_SIZE, Needle, NeedleLength);
+    BenchTime(FindTime)     Find     = string_find(Text, BENCHMARK_SEARCH_SIZE, Needle, NeedleLength);
+
+    log_info("    substring, memmem:      %lf ms", LibcFindTime);
+    log_info("    substring, string_find: %lf ms", FindTime);
+    cassert(LibcFind == Find && Find == Text + BENCHMARK_SEARCH_SIZE - NeedleLength);
+
+    mem_free(Text);
+}
+
+#define CHECK_LINES_MAX_LENGTH 256
+#define CHECK_LINES_FILEPATH   "/tmp/chibi_check_line_reader.txt"
+
+typedef struct
+{
+    const char* Text;
+    u64         TextLength;
+    char        Output[CHECK_LINES_MAX_LENGTH];
+    u64         OutputLength;
+} check_lines;
+
+// Every run of lines is non-empty, follows the previous one and ends on a line ending, except
+// at the very end of the input
+fn_internal void
+check_lines_append(char* Lines, char* LinesEnd, void* Data)
+{
+    check_lines* Check = (check_lines*)Data;
+    u64 Size = LinesEnd - Lines;
+    cassert(Size > 0 && Check->OutputLength + Size <= Check->TextLength);
+    cassert(LinesEnd[-1] == '\n' || Check->OutputLength + Size == Check->TextLength);
+
+    mem_copy(Check->Output + Check->OutputLength, Lines, Size);
+    Check->OutputLength += Size;
+}
+
+// Chunks smaller than a line, a last line without a line ending and empty input, through both
+// the line reader and the pipeline
+fn_internal void
+check_line_reader()
+{
+    typedef struct { const char* Text; u64 ChunkSize; } check_lines_case;
+    check_lines_case Cases[] =
+    {
+        { "",                                         4  },
+        { "\n",                                       1  },
+        { "\n\n\n",                                   2  },
+        { "one\ntwo\nthree\n",                        3  },
+        { "one\ntwo\nthree",                           4  },
+        { "no line ending",                           4  },
+        { "1abc2\npqr3stu8vwx\na1b2c3d4e5f\ntreb7uchet", 5  },
+        { "a line that is much longer than the chunk it is read in to\nshort\n", 8 },
+        { "short\nthen a line that is much longer than the chunk it is read in to", 8 },
+        { "fits\nin\none\nchunk\n",                    64 },
+    };
+
+    ForRange(u64, i, ArrayCount(Cases))
+    {
+        check_lines_case* Case = &Cases[i];
+        u64 TextLength = string_len(Case->Text);
+        cassert(TextLength <= CHECK_LINES_MAX_LENGTH);
+        cassert(platform_write_entire_file(CHECK_LINES_FILEPATH, (void*)Case->Text, TextLength, false) == file_io_none);
+
+        check_lines Check = { .Text = Case->Text, .TextLength = TextLength };
+        line_reader Reader;
+        cassert(line_reader_open(&Reader, CHECK_LINES_FILEPATH, Case->ChunkSize) == file_io_none);
+        char* Lines;
+        char* LinesEnd;
+        while (line_reader_next(&Reader, &Lines, &LinesEnd))
+            check_lines_append(Lines, LinesEnd, &Check);
+        cassert(Reader.Error == file_io_none);
+        line_reader_close(&Reader);
+        cassert(Check.OutputLength == TextLength && memory_equal(Check.Output, Case->Text, TextLength));
+
+        check_lines Piped = { .Text = Case->Text, .TextLength = TextLength };
+        line_pipeline_stats Stats;
+        cassert(line_pipeline_run(CHECK_LINES_FILEPATH, Case->ChunkSize, check_lines_append, &Piped, &Stats) == file_io_none);
+        cassert(Piped.OutputLength == TextLength && memory_equal(Piped.Output, Case->Text, TextLength));
+        cassert(Stats.BytesRead == TextLength);
+    }
+
+    remove(CHECK_LINES_FILEPATH);
+}
+
+void run_benchmarks()
+{
+    check_pool();
+    check_darray_typed();
+    check_darray_bulk();
+    check_darray_virtual();
+    check_small_array();
+    check_hash_map();
+    check_hash();
+    check_parse();
+    check_extract();
+    check_memory();
+    check_string_search();
+    check_line_reader();
+
+    bench_is_word_digit();
+    bench_pool();
+    bench_darray();
+    bench_small_array();
+    bench_hash_map();
+    bench_hash();
+    bench_parse();
+    bench_extract();
+    bench_memory();
+    bench_string_search();
+}
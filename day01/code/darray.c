@@ -1,5 +1,6 @@
 #include "darray.h"
 #include "chibi_core.h"
+#include "platform.h"
 
 #define HEADER_SIZE (sizeof(u64) * darray_field_length)
 
@@ -15,53 +16,139 @@ header_to_ptr(u64* Header)
     return (void*)(Header + darray_field_length);
 }
 
-void* chibi_darray_init(u64 Capacity, u64 Stride)
+// Allocates a heap array and sets up its header, the elements are left uninitialized.
+fn_internal u64*
+darray_alloc_heap(u64 Capacity, u64 Stride)
 {
     u64 ArraySize = Capacity * Stride;
     u64* Ptr = (u64*)mem_alloc(u8, HEADER_SIZE + ArraySize);
     
     //Assert(Ptr);
-    mem_zero(Ptr, HEADER_SIZE + ArraySize);
-    
     Ptr[darray_capacity] = Capacity;
     Ptr[darray_length]   = 0;
     Ptr[darray_stride]   = Stride;
+    Ptr[darray_reserved] = 0;
     
+    return Ptr;
+}
+
+void* chibi_darray_init(u64 Capacity, u64 Stride)
+{
+    u64* Ptr = darray_alloc_heap(Capacity, Stride);
+    mem_zero(header_to_ptr(Ptr), Capacity * Stride);
+    return header_to_ptr(Ptr);
+}
+
+void* chibi_darray_init_virtual(u64 MaxCapacity, u64 Stride)
+{
+    u64 PageSize    = platform_get_page_size();
+    u64 ReserveSize = forward_align(HEADER_SIZE + MaxCapacity * Stride, PageSize);
+    u64* Ptr = (u64*)platform_virtual_reserve_memory(ReserveSize);
+    if (!Ptr)
+    {
+        log_error("Failed to reserve %lu bytes for a virtual darray.", ReserveSize);
+        return NULL;
+    }
+
+    // Commit enough for the header and the default capacity, plus whatever else fits in the pages
+    u64 CommitSize = forward_align(HEADER_SIZE + DARRAY_DEFAULT_CAPACTIY * Stride, PageSize);
+    if (CommitSize > ReserveSize) CommitSize = ReserveSize;
+    platform_virtual_map_to_physical(Ptr, 0, CommitSize);
+
+    Ptr[darray_capacity] = (CommitSize - HEADER_SIZE) / Stride;
+    Ptr[darray_length]   = 0;
+    Ptr[darray_stride]   = Stride;
+    Ptr[darray_reserved] = ReserveSize;
+
     return header_to_ptr(Ptr);
 }
 
 void  chibi_darray_free(void* Array)
 {
     if (!Array) return;
-    void* Header = ptr_to_header(Array);
-    mem_free(Header);
+    u64* Header = ptr_to_header(Array);
+    if (Header[darray_reserved])
+        platform_virtual_free(Header, Header[darray_reserved]);
+    else
+        mem_free(Header);
+}
+
+// Grows the array to hold at least NewCapacity elements. Virtual arrays commit pages in place,
+// up to their reserved range, heap arrays move to a new allocation.
+fn_internal void*
+darray_grow_to(void* Array, u64 NewCapacity)
+{
+    u64* Header  = ptr_to_header(Array);
+    u64 Capacity = Header[darray_capacity];
+    u64 Length   = Header[darray_length];
+    u64 Stride   = Header[darray_stride];
+    u64 Reserved = Header[darray_reserved];
+
+    if (Reserved)
+    {
+        u64 PageSize = platform_get_page_size();
+
+        u64 OldCommitSize = forward_align(HEADER_SIZE + Capacity * Stride, PageSize);
+        u64 NewCommitSize = forward_align(HEADER_SIZE + NewCapacity * Stride, PageSize);
+        if (NewCommitSize > Reserved) NewCommitSize = Reserved;
+
+        if (NewCommitSize > OldCommitSize)
+        {
+            platform_virtual_map_to_physical(Header, OldCommitSize, NewCommitSize - OldCommitSize);
+            Header[darray_capacity] = (NewCommitSize - HEADER_SIZE) / Stride;
+        }
+
+        return Array;
+    }
+
+    // Same as chibi_darray_init, the elements past the length are zero. Only those are cleared
+    // since the rest is copied over.
+    void* NewArray = header_to_ptr(darray_alloc_heap(NewCapacity, Stride));
+    chibi_darray_field_set(NewArray, Length, darray_length);
+    mem_copy(NewArray, Array, Stride * Length);
+    mem_zero((u8*)NewArray + Stride * Length, Stride * (NewCapacity - Length));
+
+    chibi_darray_free(Array);
+    return NewArray;
+}
+
+// Makes room for Length + Count elements with a single capacity check.
+fn_internal void*
+darray_ensure_space(void* Array, u64 Count)
+{
+    u64 Required = darray_len(Array) + Count;
+    u64 Capacity = darray_cap(Array);
+    if (Required <= Capacity) return Array;
+
+    u64 NewCapacity = Capacity * DARRAY_DEFAULT_RESIZE_FACTOR;
+    if (NewCapacity < Required) NewCapacity = Required;
+
+    Array = darray_grow_to(Array, NewCapacity);
+    cassert_custom(Required <= darray_cap(Array), "Virtual darray is out of reserved space.");
+    return Array;
 }
 
 void* chibi_darray_resize(void* OldArray)
 {
     u64 OldCapacity = chibi_darray_field_get(OldArray, darray_capacity);
-    u64 OldStride   = chibi_darray_field_get(OldArray, darray_stride);
-    u64 OldLength   = chibi_darray_field_get(OldArray, darray_length);
-    
-    void* NewArray = chibi_darray_init(OldCapacity * DARRAY_DEFAULT_RESIZE_FACTOR, OldStride);
-    chibi_darray_field_set(NewArray, OldLength, darray_length);
-    
-    u64 CopySize = OldStride * OldLength;
-    mem_copy(NewArray, OldArray, CopySize);
-    
-    chibi_darray_free(OldArray);
-    
-    return NewArray;
+    return darray_grow_to(OldArray, OldCapacity * DARRAY_DEFAULT_RESIZE_FACTOR);
+}
+
+void* chibi_darray_reserve_exact(void* Array, u64 Capacity)
+{
+    if (Capacity <= darray_cap(Array)) return Array;
+
+    Array = darray_grow_to(Array, Capacity);
+    cassert_custom(Capacity <= darray_cap(Array), "Virtual darray is out of reserved space.");
+    return Array;
 }
 
 void* chibi_darray_push(void* Array, void* ValuePtr)
 {
     u64 Length = darray_len(Array);
     u64 Stride = chibi_darray_field_get(Array, darray_stride);
-    if (Length + 1 >= darray_cap(Array))
-    {
-        Array = chibi_darray_resize(Array);
-    }
+    if (Length == darray_cap(Array))
+        Array = darray_ensure_space(Array, 1);
     
     u64 Addr = (u64)Array;
     Addr += (Length * Stride);
@@ -76,7 +163,6 @@ void*
 chibi_darray_push_at(void* Array, u64 Index, void* Destination)
 {
     u64 Length = darray_len(Array);
-    u64 Stride = chibi_darray_field_get(Array, darray_stride);
     
     if (Index >= Length)
     {
@@ -84,26 +170,7 @@ chibi_darray_push_at(void* Array, u64 Index, void* Destination)
         return Array;
     }
     
-    if (Length + 1 >= darray_cap(Array))
-    {
-        Array = chibi_darray_resize(Array);
-    }
-    
-    u64 Addr = (u64)Array;
-    
-    if (Index != Length - 1)
-    { // Make room for the new element
-        mem_copy((void*)(Addr + ((Index + 1) * Stride)),
-                 (void*)(Addr + (Index * Stride)),
-                 Stride * (Length - Index));
-    }
-    
-    // Insert the element
-    mem_copy((void*)(Addr + (Index * Stride)), Destination, Stride);
-    
-    chibi_darray_field_set(Array, Length + 1, darray_length);
-    
-    return Array;
+    return chibi_darray_insert_range(Array, Index, Destination, 1);
 }
 
 void 
@@ -142,17 +209,152 @@ chibi_darray_pop_at(void* Array, u64 Index, void* Destination)
         mem_copy(Destination, (void*)(Addr + (Index * Stride)), Stride);
     }
     
-    if (Index != Length - 1) {
-        mem_copy((void*)(Addr + (Index * Stride)),
-                 (void*)(Addr + ((Index + 1) * Stride)),
-                 Stride * (Length - Index));
-    }
-    
-    chibi_darray_field_set(Array, Length - 1, darray_length);
+    chibi_darray_erase_range(Array, Index, 1);
     
     return Array;
 }
 
+void* 
+chibi_darray_append_n(void* Array, void* Values, u64 Count)
+{
+    if (Count == 0) return Array;
+    Array = darray_ensure_space(Array, Count);
+
+    u64 Length = darray_len(Array);
+    u64 Stride = chibi_darray_field_get(Array, darray_stride);
+
+    mem_copy((u8*)Array + Length * Stride, Values, Count * Stride);
+    chibi_darray_field_set(Array, Length + Count, darray_length);
+
+    return Array;
+}
+
+void* 
+chibi_darray_insert_range(void* Array, u64 Index, void* Values, u64 Count)
+{
+    u64 Length = darray_len(Array);
+    if (Index > Length)
+    {
+        //LOG_ERROR("Attempting to insert into dynamic array with length (%d) at index (%d).", Length, Index);
+        return Array;
+    }
+
+    if (Count == 0) return Array;
+    Array = darray_ensure_space(Array, Count);
+
+    u64 Stride = chibi_darray_field_get(Array, darray_stride);
+    u8* Insert = (u8*)Array + Index * Stride;
+
+    // Make room for the new elements
+    mem_move(Insert + Count * Stride, Insert, (Length - Index) * Stride);
+    mem_copy(Insert, Values, Count * Stride);
+
+    chibi_darray_field_set(Array, Length + Count, darray_length);
+    return Array;
+}
+
+void 
+chibi_darray_erase_range(void* Array, u64 Index, u64 Count)
+{
+    u64 Length = darray_len(Array);
+    if (Index >= Length) return;
+    if (Count > Length - Index) Count = Length - Index;
+
+    u64 Stride = chibi_darray_field_get(Array, darray_stride);
+    u8* Erase  = (u8*)Array + Index * Stride;
+
+    mem_move(Erase, Erase + Count * Stride, (Length - Index - Count) * Stride);
+    chibi_darray_field_set(Array, Length - Count, darray_length);
+}
+
+void* 
+chibi_darray_resize_uninit(void* Array, u64 Length)
+{
+    u64 OldLength = darray_len(Array);
+    if (Length > OldLength)
+        Array = darray_ensure_space(Array, Length - OldLength);
+
+    chibi_darray_field_set(Array, Length, darray_length);
+    return Array;
+}
+
+void 
+chibi_darray_typed_grow(void** Data, u64* Capacity, u64 Length, u64 Stride, u64 MinCapacity)
+{
+    u64 NewCapacity = *Capacity * DARRAY_DEFAULT_RESIZE_FACTOR;
+    if (NewCapacity < MinCapacity)               NewCapacity = MinCapacity;
+    if (NewCapacity < DARRAY_TYPED_MIN_CAPACITY) NewCapacity = DARRAY_TYPED_MIN_CAPACITY;
+
+    void* NewData = mem_alloc(u8, NewCapacity * Stride);
+    if (*Data)
+    {
+        mem_copy(NewData, *Data, Length * Stride);
+        mem_free(*Data);
+    }
+
+    *Data     = NewData;
+    *Capacity = NewCapacity;
+}
+
+void 
+chibi_darray_typed_free(void* Data)
+{
+    if (Data) mem_free(Data);
+}
+
+void
+darray_extract_integers(str_view Text, darray_s64* Values, darray_u64* LineOffsets)
+{
+    // A counting pass is much cheaper than guessing from the text length, which has to assume
+    // the densest input and reserves several times the text size for text with few numbers
+    integer_extract_result Counts = str_view_count_integers(Text);
+
+    u64 BaseValue = Values->Length;
+    darray_s64_reserve(Values, Values->Length + Counts.ValueCount);
+    if (LineOffsets) darray_u64_reserve(LineOffsets, LineOffsets->Length + Counts.LineCount + 1);
+
+    u64* Lines = LineOffsets ? LineOffsets->Data + LineOffsets->Length : NULL;
+    integer_extract_result Result = str_view_extract_integers(Text, Values->Data + Values->Length, Counts.ValueCount,
+                                                              Lines, LineOffsets ? Counts.LineCount + 1 : 0);
+    cassert(Result.ValueCount == Counts.ValueCount && (!LineOffsets || Result.LineCount == Counts.LineCount));
+
+    Values->Length += Result.ValueCount;
+    if (LineOffsets)
+    {
+        ForRange(u64, i, Result.LineCount + 1)
+            Lines[i] += BaseValue;
+        LineOffsets->Length += Result.LineCount + 1;
+    }
+}
+
+void 
+chibi_small_array_grow(void** Data, u64* Capacity, void* Inline, u64 Length,
+                       u64 Stride, u64 Alignment, memory_arena* Arena, u64 MinCapacity)
+{
+    // While inline the length stands in for the capacity, it is the inline count when a push spills
+    u64 OldCapacity = *Data ? *Capacity : Length;
+    u64 NewCapacity = OldCapacity * DARRAY_DEFAULT_RESIZE_FACTOR;
+    if (NewCapacity < MinCapacity) NewCapacity = MinCapacity;
+
+    void* NewData = NULL;
+    if (Arena)
+    {
+        NewData = arena_push(Arena, NewCapacity * Stride, Alignment);
+        cassert_custom(NewData, "Small array failed to spill in to its arena.");
+    }
+    else
+    {
+        NewData = mem_alloc(u8, NewCapacity * Stride);
+    }
+
+    void* OldData = *Data ? *Data : Inline;
+    mem_copy(NewData, OldData, Length * Stride);
+    if (*Data && !Arena) mem_free(*Data);
+
+    *Data     = NewData;
+    *Capacity = NewCapacity;
+}
+
 u64 
 chibi_darray_field_get(void* Array, u64 Field)
 {
@@ -2,12 +2,14 @@
 #define _DARRAY_H_
 
 #include "chibi_types.h"
+#include "chibi_core.h"
 
 typedef enum 
 {
     darray_capacity,
     darray_length,
     darray_stride,
+    darray_reserved, // Bytes of address space reserved for a virtual array, 0 for heap arrays
     darray_field_length,
 } darray_fields;
 
@@ -18,6 +20,10 @@ typedef enum
 #define darray_init(Type)              chibi_darray_init(DARRAY_DEFAULT_CAPACTIY, sizeof(Type))
 // Initializes the array with the specified capacity
 #define darray_reserve(Type, Capacity) chibi_darray_init(Capacity, sizeof(Type))
+// Initializes an array that reserves address space for MaxCapacity elements up front and
+// grows by committing pages in place. It never moves, so pointers in to it stay valid.
+// Returns NULL if the address space can't be reserved.
+#define darray_init_virtual(Type, MaxCapacity) chibi_darray_init_virtual(MaxCapacity, sizeof(Type))
 // Frees the array
 #define darray_free(Array)             chibi_darray_free(Array)
 // Retrieves the array length 
@@ -37,7 +43,7 @@ typedef enum
 // Push an element into the array at the specified index
 #define darray_push_at(Array, Index, Value) {        \
         typeof(Value) Copy = Value;                  \
-        Array = chibi_darray_push_at(Array, Index, &Value); \
+        Array = chibi_darray_push_at(Array, Index, &Copy); \
     }
     
 // Removes an element from the end of the list
@@ -48,7 +54,22 @@ typedef enum
 // A ptr to the array is returned.
 #define darray_pop_at(Array, Index, ValuePtr) chibi_darray_pop_at(Array, Index, ValuePtr)
 
+// Bulk operations, each does a single capacity check and a single copy or move. Values must not
+// point in to the array itself, growing can move the array before the copy.
+
+// Grows the capacity to exactly Capacity elements, if it is not already that large
+#define darray_reserve_exact(Array, Capacity)            (Array = chibi_darray_reserve_exact(Array, Capacity))
+// Copies Count elements from Values on to the end of the array
+#define darray_append_n(Array, Values, Count)            (Array = chibi_darray_append_n(Array, Values, Count))
+// Copies Count elements from Values in to the array at Index, Index may be the array length
+#define darray_insert_range(Array, Index, Values, Count) (Array = chibi_darray_insert_range(Array, Index, Values, Count))
+// Removes Count elements starting at Index, the elements after them are shifted down
+#define darray_erase_range(Array, Index, Count)          chibi_darray_erase_range(Array, Index, Count)
+// Sets the length, growing if needed. New elements are left uninitialized for the caller to fill.
+#define darray_resize_uninit(Array, Length)              (Array = chibi_darray_resize_uninit(Array, Length))
+
 void* chibi_darray_init(u64 Capacity, u64 Stride);
+void* chibi_darray_init_virtual(u64 MaxCapacity, u64 Stride);
 void  chibi_darray_free(void* Array);
 
 void* chibi_darray_resize(void* OldArray);
@@ -59,6 +80,132 @@ void* chibi_darray_push_at(void* Array, u64 Index, void* Destination);
 void  chibi_darray_pop(void* Array, void* Destination);
 void* chibi_darray_pop_at(void* Array, u64 Index, void* Destination);
 
+void* chibi_darray_reserve_exact(void* Array, u64 Capacity);
+void* chibi_darray_append_n(void* Array, void* Values, u64 Count);
+void* chibi_darray_insert_range(void* Array, u64 Index, void* Values, u64 Count);
+void  chibi_darray_erase_range(void* Array, u64 Index, u64 Count);
+void* chibi_darray_resize_uninit(void* Array, u64 Length);
+
+//
+// Typed arrays
+//
+// DARRAY_DEFINE(Type) generates darray_Type, an array whose element size is known at compile
+// time, along with inline functions that compile to straight-line code. A zeroed struct is a
+// valid empty array. Only growth goes out of line. Memory comes from mem_alloc, so the arrays
+// follow a bound arena. Use DARRAY_DEFINE_NAMED for types whose names aren't a single token.
+//
+// Indices are not bounds checked.
+//
+
+#define DARRAY_TYPED_MIN_CAPACITY 16
+
+#define DARRAY_DEFINE(Type) DARRAY_DEFINE_NAMED(Type, Type)
+#define DARRAY_DEFINE_NAMED(Type, Name)                                                                             \
+    typedef struct { Type* Data; u64 Length; u64 Capacity; } darray_##Name;                                         \
+                                                                                                                    \
+    fn_inline void darray_##Name##_reserve(darray_##Name* Array, u64 Capacity)                                      \
+    {                                                                                                               \
+        if (Capacity > Array->Capacity)                                                                             \
+            chibi_darray_typed_grow((void**)&Array->Data, &Array->Capacity, Array->Length, sizeof(Type), Capacity); \
+    }                                                                                                               \
+    fn_inline void darray_##Name##_push(darray_##Name* Array, Type Value)                                           \
+    {                                                                                                               \
+        if (Array->Length == Array->Capacity)                                                                       \
+            chibi_darray_typed_grow((void**)&Array->Data, &Array->Capacity, Array->Length, sizeof(Type),        \
+                                    Array->Length + 1);                                                             \
+        Array->Data[Array->Length++] = Value;                                                                       \
+    }                                                                                                               \
+    fn_inline void darray_##Name##_append_n(darray_##Name* Array, const Type* Values, u64 Count)                    \
+    {                                                                                                               \
+        darray_##Name##_reserve(Array, Array->Length + Count);                                                      \
+        Type* Dest = Array->Data + Array->Length;                                                                   \
+        for (u64 i = 0; i < Count; ++i) Dest[i] = Values[i];                                                        \
+        Array->Length += Count;                                                                                     \
+    }                                                                                                               \
+    fn_inline Type  darray_##Name##_pop(darray_##Name* Array)                       { return Array->Data[--Array->Length]; } \
+    fn_inline Type  darray_##Name##_get(darray_##Name* Array, u64 Index)            { return Array->Data[Index]; }   \
+    fn_inline Type* darray_##Name##_at(darray_##Name* Array, u64 Index)             { return Array->Data + Index; }  \
+    fn_inline void  darray_##Name##_set(darray_##Name* Array, u64 Index, Type Value) { Array->Data[Index] = Value; } \
+    fn_inline void  darray_##Name##_clear(darray_##Name* Array)                     { Array->Length = 0; }           \
+    fn_inline void  darray_##Name##_free(darray_##Name* Array)                                                      \
+    {                                                                                                               \
+        chibi_darray_typed_free(Array->Data);                                                                       \
+        Array->Data     = NULL;                                                                                     \
+        Array->Length   = 0;                                                                                        \
+        Array->Capacity = 0;                                                                                        \
+    }
+
+// Slow path for typed arrays, grows *Data to at least MinCapacity elements of Stride bytes.
+void chibi_darray_typed_grow(void** Data, u64* Capacity, u64 Length, u64 Stride, u64 MinCapacity);
+void chibi_darray_typed_free(void* Data);
+
+DARRAY_DEFINE(s32)
+DARRAY_DEFINE(u32)
+DARRAY_DEFINE(s64)
+DARRAY_DEFINE(u64)
+
+// Appends every integer in Text to Values, see str_view_extract_integers. If LineOffsets isn't
+// NULL, the index in Values of each line's first integer is appended to it, followed by the
+// final length of Values.
+void darray_extract_integers(str_view Text, darray_s64* Values, darray_u64* LineOffsets);
+
+//
+// Small arrays
+//
+// SMALL_ARRAY_DEFINE(Type, InlineCount) generates small_array_Type_InlineCount, which keeps its
+// first InlineCount elements inside the struct and only allocates once it outgrows them. A
+// zeroed struct is a valid empty array. Data is NULL while the elements are inline, so the
+// struct can be copied around until it spills. Set Arena before the first push to spill in to
+// an arena instead of mem_alloc, arena memory is not freed by small_array_*_free.
+//
+
+#define SMALL_ARRAY_DEFINE(Type, InlineCount) SMALL_ARRAY_DEFINE_NAMED(Type, InlineCount, Type##_##InlineCount)
+#define SMALL_ARRAY_DEFINE_NAMED(Type, InlineCount, Name)                                                           \
+    typedef struct                                                                                                  \
+    {                                                                                                               \
+        Type*         Data;     /* NULL while the elements are inline */                                            \
+        u64           Length;                                                                                       \
+        u64           Capacity; /* Only valid once spilled */                                                       \
+        memory_arena* Arena;    /* Optional spill target */                                                         \
+        Type          Inline[InlineCount];                                                                          \
+    } small_array_##Name;                                                                                           \
+                                                                                                                    \
+    fn_inline Type* small_array_##Name##_data(small_array_##Name* Array)                                            \
+    { return Array->Data ? Array->Data : Array->Inline; }                                                           \
+    fn_inline u64 small_array_##Name##_len(small_array_##Name* Array) { return Array->Length; }                     \
+    fn_inline u64 small_array_##Name##_cap(small_array_##Name* Array)                                               \
+    { return Array->Data ? Array->Capacity : (InlineCount); }                                                       \
+    fn_inline void small_array_##Name##_reserve(small_array_##Name* Array, u64 Capacity)                            \
+    {                                                                                                               \
+        if (Capacity > small_array_##Name##_cap(Array))                                                             \
+            chibi_small_array_grow((void**)&Array->Data, &Array->Capacity, Array->Inline, Array->Length,            \
+                                   sizeof(Type), _Alignof(Type), Array->Arena, Capacity);                           \
+    }                                                                                                               \
+    fn_inline void small_array_##Name##_push(small_array_##Name* Array, Type Value)                                 \
+    {                                                                                                               \
+        small_array_##Name##_reserve(Array, Array->Length + 1);                                                     \
+        small_array_##Name##_data(Array)[Array->Length++] = Value;                                                  \
+    }                                                                                                               \
+    fn_inline Type small_array_##Name##_pop(small_array_##Name* Array)                                              \
+    { return small_array_##Name##_data(Array)[--Array->Length]; }                                                   \
+    fn_inline Type small_array_##Name##_get(small_array_##Name* Array, u64 Index)                                   \
+    { return small_array_##Name##_data(Array)[Index]; }                                                             \
+    fn_inline void small_array_##Name##_set(small_array_##Name* Array, u64 Index, Type Value)                       \
+    { small_array_##Name##_data(Array)[Index] = Value; }                                                            \
+    fn_inline void small_array_##Name##_clear(small_array_##Name* Array) { Array->Length = 0; }                     \
+    fn_inline void small_array_##Name##_free(small_array_##Name* Array)                                             \
+    {                                                                                                               \
+        if (Array->Data && !Array->Arena) mem_free(Array->Data);                                                    \
+        Array->Data     = NULL;                                                                                     \
+        Array->Length   = 0;                                                                                        \
+        Array->Capacity = 0;                                                                                        \
+    }
+
+// Slow path for small arrays, moves the elements (inline or already spilled) to a new
+// allocation of at least MinCapacity elements.
+void chibi_small_array_grow(void** Data, u64* Capacity, void* Inline, u64 Length,
+                            u64 Stride, u64 Alignment, memory_arena* Arena, u64 MinCapacity);
+
 u64 chibi_darray_field_get(void* Array, u64 Field);
 u64 chibi_darray_field_set(void* Array, u64 Value, u64 Field);
 
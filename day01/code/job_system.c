@@ -0,0 +1,299 @@
+#include "job_system.h"
+#include "chibi_core.h"
+#include "platform.h"
+
+#define JOB_QUEUE_CAPACITY 4096 // Must be a power of 2
+#define JOB_QUEUE_MASK     (JOB_QUEUE_CAPACITY - 1)
+#define JOB_SPIN_COUNT     64   // Steal attempts before an idle worker goes to sleep
+
+typedef struct
+{
+    job_fn*      Fn;
+    void*        Data;
+    job_counter* Counter;
+} job;
+
+// Top and Bottom are on separate cache lines, thieves write Top and the owner writes Bottom.
+typedef struct
+{
+    s64 volatile Top;
+    u8           Padding0[56];
+    s64 volatile Bottom;
+    u8           Padding1[56];
+    job          Jobs[JOB_QUEUE_CAPACITY];
+} job_queue;
+
+typedef struct
+{
+    u32              WorkerCount;
+    job_queue*       Queues;
+    platform_thread* Threads;
+
+    platform_semaphore Wake;
+    s32 volatile       SleepingCount;
+    s32 volatile       Running;
+} job_system;
+
+var_global job_system gJobs = {0};
+
+// -1 for threads that are not part of the job system
+var_thread_local s32 tWorkerIndex = -1;
+
+//
+// Chase-Lev deque
+//
+
+// Owner only. Returns false if the queue is full.
+fn_internal bool
+job_queue_push(job_queue* Queue, job Job)
+{
+    s64 Bottom = atomic_load_explicit_s64(&Queue->Bottom, atomic_order_relaxed);
+    s64 Top    = atomic_load_explicit_s64(&Queue->Top,    atomic_order_acquire);
+    if (Bottom - Top >= JOB_QUEUE_CAPACITY)
+        return false;
+
+    Queue->Jobs[Bottom & JOB_QUEUE_MASK] = Job;
+    atomic_store_explicit_s64(&Queue->Bottom, Bottom + 1, atomic_order_release);
+    return true;
+}
+
+// Owner only. Takes the most recently pushed job.
+fn_internal bool
+job_queue_pop(job_queue* Queue, job* OutJob)
+{
+    s64 Bottom = atomic_load_explicit_s64(&Queue->Bottom, atomic_order_relaxed) - 1;
+    atomic_store_explicit_s64(&Queue->Bottom, Bottom, atomic_order_relaxed);
+    atomic_thread_fence(atomic_order_seq_cst);
+    s64 Top = atomic_load_explicit_s64(&Queue->Top, atomic_order_relaxed);
+
+    if (Top > Bottom)
+    { // Queue was empty
+        atomic_store_explicit_s64(&Queue->Bottom, Bottom + 1, atomic_order_relaxed);
+        return false;
+    }
+
+    *OutJob = Queue->Jobs[Bottom & JOB_QUEUE_MASK];
+    if (Top != Bottom)
+        return true;
+
+    // Last job in the queue, race the thieves for it
+    bool Won = atomic_compare_exchange_explicit_s64(&Queue->Top, &Top, Top + 1,
+            atomic_order_seq_cst, atomic_order_relaxed);
+    atomic_store_explicit_s64(&Queue->Bottom, Bottom + 1, atomic_order_relaxed);
+    return Won;
+}
+
+// Any thread. Takes the oldest job.
+fn_internal bool
+job_queue_steal(job_queue* Queue, job* OutJob)
+{
+    s64 Top = atomic_load_explicit_s64(&Queue->Top, atomic_order_acquire);
+    atomic_thread_fence(atomic_order_seq_cst);
+    s64 Bottom = atomic_load_explicit_s64(&Queue->Bottom, atomic_order_acquire);
+
+    if (Top >= Bottom)
+        return false;
+
+    job Job = Queue->Jobs[Top & JOB_QUEUE_MASK];
+    if (!atomic_compare_exchange_explicit_s64(&Queue->Top, &Top, Top + 1,
+                atomic_order_seq_cst, atomic_order_relaxed))
+        return false;
+
+    *OutJob = Job;
+    return true;
+}
+
+//
+// Workers
+//
+
+fn_internal void
+job_run(job* Job)
+{
+    Job->Fn(Job->Data);
+    if (Job->Counter)
+        atomic_fetch_sub_s32(&Job->Counter->Value, 1);
+}
+
+// Pops from the worker's own queue first, then tries to steal from every other worker.
+fn_internal bool
+job_find(u32 WorkerIndex, job* OutJob)
+{
+    if (job_queue_pop(&gJobs.Queues[WorkerIndex], OutJob))
+        return true;
+
+    for (u32 i = 1; i < gJobs.WorkerCount; ++i)
+    {
+        u32 Victim = (WorkerIndex + i) % gJobs.WorkerCount;
+        if (job_queue_steal(&gJobs.Queues[Victim], OutJob))
+            return true;
+    }
+
+    return false;
+}
+
+fn_internal void*
+job_worker_proc(void* Data)
+{
+    tWorkerIndex = (s32)(uptr)Data;
+
+    job Job;
+    while (atomic_load_s32(&gJobs.Running))
+    {
+        bool Found = false;
+        ForRange(int, Spin, JOB_SPIN_COUNT)
+        {
+            Found = job_find(tWorkerIndex, &Job);
+            if (Found) break;
+            atomic_pause();
+        }
+
+        if (!Found)
+        { // Announce that we are going to sleep, then check one last time so a job submitted
+          // in between isn't missed. job_submit checks SleepingCount after pushing.
+            atomic_fetch_add_s32(&gJobs.SleepingCount, 1);
+            Found = job_find(tWorkerIndex, &Job);
+            if (!Found && atomic_load_s32(&gJobs.Running))
+                platform_semaphore_wait(&gJobs.Wake);
+            atomic_fetch_sub_s32(&gJobs.SleepingCount, 1);
+        }
+
+        if (Found)
+            job_run(&Job);
+    }
+
+    return NULL;
+}
+
+void job_system_init(u32 WorkerCount)
+{
+    cassert(gJobs.WorkerCount == 0);
+    if (WorkerCount == 0) WorkerCount = 1;
+
+    gJobs.WorkerCount   = WorkerCount;
+    gJobs.Queues        = mem_alloc(job_queue, WorkerCount);
+    gJobs.Threads       = mem_alloc(platform_thread, WorkerCount);
+    gJobs.SleepingCount = 0;
+    gJobs.Running       = 1;
+    platform_semaphore_init(&gJobs.Wake, 0);
+
+    ForRange(u32, i, WorkerCount)
+    {
+        gJobs.Queues[i].Top    = 0;
+        gJobs.Queues[i].Bottom = 0;
+    }
+
+    tWorkerIndex = 0;
+    for (u32 i = 1; i < WorkerCount; ++i)
+    {
+        bool Created = platform_thread_create(&gJobs.Threads[i], job_worker_proc, (void*)(uptr)i);
+        cassert(Created);
+    }
+}
+
+void job_system_shutdown()
+{
+    atomic_store_s32(&gJobs.Running, 0);
+    for (u32 i = 1; i < gJobs.WorkerCount; ++i)
+        platform_semaphore_post(&gJobs.Wake);
+    for (u32 i = 1; i < gJobs.WorkerCount; ++i)
+        platform_thread_join(&gJobs.Threads[i]);
+
+    platform_semaphore_deinit(&gJobs.Wake);
+    mem_free(gJobs.Queues);
+    mem_free(gJobs.Threads);
+    mem_zero(&gJobs, sizeof(job_system));
+    tWorkerIndex = -1;
+}
+
+u32 job_system_worker_count()
+{
+    return gJobs.WorkerCount;
+}
+
+void job_submit(job_fn* Fn, void* Data, job_counter* Counter)
+{
+    cassert_custom(tWorkerIndex >= 0, "Jobs can only be submitted from a job system thread.");
+
+    job Job = { .Fn = Fn, .Data = Data, .Counter = Counter };
+    if (Counter)
+        atomic_fetch_add_s32(&Counter->Value, 1);
+
+    if (!job_queue_push(&gJobs.Queues[tWorkerIndex], Job))
+    { // Queue is full, run the job now instead
+        job_run(&Job);
+        return;
+    }
+
+    // Pairs with the sleep announcement in job_worker_proc
+    atomic_thread_fence(atomic_order_seq_cst);
+    if (atomic_load_s32(&gJobs.SleepingCount) > 0)
+        platform_semaphore_post(&gJobs.Wake);
+}
+
+void job_wait(job_counter* Counter)
+{
+    job Job;
+    while (atomic_load_s32(&Counter->Value) > 0)
+    {
+        if (tWorkerIndex >= 0 && job_find(tWorkerIndex, &Job))
+            job_run(&Job);
+        else
+            atomic_pause();
+    }
+}
+
+typedef struct
+{
+    parallel_for_fn* Fn;
+    void*            Data;
+    u64              Start;
+    u64              End;
+} parallel_for_range;
+
+fn_internal void
+parallel_for_proc(void* Data)
+{
+    parallel_for_range* Range = (parallel_for_range*)Data;
+    Range->Fn(Range->Start, Range->End, Range->Data);
+}
+
+void parallel_for(u64 Start, u64 End, u64 Grain, parallel_for_fn* Fn, void* Data)
+{
+    if (End <= Start) return;
+    if (Grain == 0) Grain = 1;
+
+    u64 RangeCount = DivideAlign(End - Start, Grain);
+    if (RangeCount == 1 || gJobs.WorkerCount <= 1)
+    {
+        Fn(Start, End, Data);
+        return;
+    }
+
+    // Scratch rather than mem_alloc, mem_free is a no-op when an arena is bound to the thread.
+    // Jobs run by job_wait below finish before it returns, so any scratch they use is
+    // released before this one.
+    arena_marker Scratch = scratch_begin(NULL, 0);
+    parallel_for_range* Ranges = arena_push_array(Scratch.Arena, parallel_for_range, RangeCount);
+    cassert(Ranges);
+
+    job_counter Counter = {0};
+
+    ForRange(u64, i, RangeCount)
+    {
+        u64 RangeStart = Start + i * Grain;
+        u64 RangeEnd   = (RangeStart + Grain < End) ? RangeStart + Grain : End;
+
+        Ranges[i] = (parallel_for_range) {
+            .Fn    = Fn,
+            .Data  = Data,
+            .Start = RangeStart,
+            .End   = RangeEnd,
+        };
+
+        job_submit(parallel_for_proc, &Ranges[i], &Counter);
+    }
+
+    job_wait(&Counter);
+    scratch_end(Scratch);
+}
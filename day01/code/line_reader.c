@@ -0,0 +1,257 @@
+#include "line_reader.h"
+#include "chibi_core.h"
+
+file_io_error line_reader_open(line_reader* Reader, const char* Filepath, u64 ChunkSize)
+{
+    mem_zero(Reader, sizeof(line_reader));
+
+    Reader->Error = platform_open_file_stream(Filepath, &Reader->Stream);
+    if (Reader->Error != file_io_none)
+        return Reader->Error;
+
+    Reader->Buffer     = mem_alloc(char, ChunkSize);
+    Reader->BufferSize = ChunkSize;
+    return file_io_none;
+}
+
+void line_reader_close(line_reader* Reader)
+{
+    platform_close_file_stream(&Reader->Stream);
+    mem_free(Reader->Buffer);
+    Reader->Buffer = NULL;
+}
+
+// Reads from the stream until Buffer is full or the stream ends, returns the new fill size.
+fn_internal u64
+line_reader_fill(platform_file_stream* Stream, char* Buffer, u64 Filled, u64 BufferSize,
+        bool* EndOfStream, file_io_error* Error)
+{
+    // Pipes and sockets return short reads, keep reading until the buffer is full
+    while (Filled < BufferSize && !*EndOfStream)
+    {
+        s64 ReadBytes = platform_read_file_stream(Stream, Buffer + Filled, BufferSize - Filled);
+        if (ReadBytes <= 0)
+        {
+            if (ReadBytes < 0) *Error = file_io_failed_to_read;
+            *EndOfStream = true;
+        }
+        else
+        {
+            Filled += (u64)ReadBytes;
+        }
+    }
+
+    return Filled;
+}
+
+// Returns the size of the complete lines at the start of Buffer. Returns 0 if the buffer doesn't
+// hold a single complete line yet, the caller has to grow the buffer and read more.
+fn_internal u64
+line_reader_find_lines_end(char* Buffer, u64 Filled, bool EndOfStream)
+{
+    // At the end of the stream the last line doesn't need a line ending
+    if (EndOfStream) return Filled;
+
+    u64 LinesEnd = Filled;
+    while (LinesEnd > 0)
+    {
+        char Char = Buffer[LinesEnd - 1];
+        if (Char == '\n' || Char == '\r') break;
+        LinesEnd -= 1;
+    }
+
+    return LinesEnd;
+}
+
+// Doubles the size of Buffer to make room for a line longer than it, keeping the first Filled
+// bytes. Splitting the line instead would make the caller parse each piece as its own line.
+fn_internal char*
+line_reader_grow(char* Buffer, u64 Filled, u64* BufferSize)
+{
+    u64   NewSize = *BufferSize * 2;
+    char* Result  = mem_alloc(char, NewSize);
+    cassert_custom(Result, "Failed to grow the line reader's buffer.");
+
+    mem_copy(Result, Buffer, Filled);
+    mem_free(Buffer);
+
+    *BufferSize = NewSize;
+    return Result;
+}
+
+bool line_reader_next(line_reader* Reader, char** OutStart, char** OutEnd)
+{
+    // Carry the partial line left over from the previous call to the front of the buffer
+    u64 Carry = Reader->Filled - Reader->Consumed;
+    if (Carry > 0 && Reader->Consumed > 0)
+        mem_move(Reader->Buffer, Reader->Buffer + Reader->Consumed, Carry);
+
+    Reader->Consumed = 0;
+    Reader->Filled   = Carry;
+    for (;;)
+    {
+        Reader->Filled = line_reader_fill(&Reader->Stream, Reader->Buffer, Reader->Filled, Reader->BufferSize,
+                &Reader->EndOfStream, &Reader->Error);
+
+        if (Reader->Filled == 0)
+            return false;
+
+        Reader->Consumed = line_reader_find_lines_end(Reader->Buffer, Reader->Filled, Reader->EndOfStream);
+        if (Reader->Consumed > 0)
+            break;
+
+        // The buffer is full and still holds part of a single line
+        Reader->Buffer = line_reader_grow(Reader->Buffer, Reader->Filled, &Reader->BufferSize);
+    }
+
+    *OutStart = Reader->Buffer;
+    *OutEnd   = Reader->Buffer + Reader->Consumed;
+    return true;
+}
+
+//
+// Pipeline
+//
+
+typedef struct
+{
+    char* Buffer;
+    u64   BufferSize; // Starts at the chunk size, grown by the reader for long lines
+    u64   LinesSize;
+    bool  Last;
+} line_pipeline_slot;
+
+typedef struct
+{
+    platform_file_stream Stream;
+    file_io_error        Error;
+
+    line_pipeline_slot Slots[2];
+    platform_semaphore FreeSlots;
+    platform_semaphore FilledSlots;
+
+    f64 ReadMs;
+    f64 ReadStallMs;
+    u64 BytesRead;
+} line_pipeline;
+
+fn_internal void*
+line_pipeline_reader_proc(void* Data)
+{
+    line_pipeline* Pipeline = (line_pipeline*)Data;
+
+    bool  EndOfStream = false;
+    char* Carry       = NULL;
+    u64   CarrySize   = 0;
+
+    for (u64 SlotIndex = 0; ; ++SlotIndex)
+    {
+        line_pipeline_slot* Slot = &Pipeline->Slots[SlotIndex % 2];
+
+        f64 WaitBegin = wall_clock_ms();
+        platform_semaphore_wait(&Pipeline->FreeSlots);
+        f64 ReadBegin = wall_clock_ms();
+
+        // The other slot may have grown past this one for a long line
+        while (CarrySize > Slot->BufferSize)
+            Slot->Buffer = line_reader_grow(Slot->Buffer, 0, &Slot->BufferSize);
+
+        // The carry lives past the lines of the other slot, which the consumer doesn't touch
+        if (CarrySize > 0)
+            mem_copy(Slot->Buffer, Carry, CarrySize);
+
+        u64 Filled = CarrySize;
+        for (;;)
+        {
+            Filled = line_reader_fill(&Pipeline->Stream, Slot->Buffer, Filled, Slot->BufferSize,
+                    &EndOfStream, &Pipeline->Error);
+
+            Slot->LinesSize = line_reader_find_lines_end(Slot->Buffer, Filled, EndOfStream);
+            if (Slot->LinesSize > 0 || EndOfStream)
+                break;
+
+            // The slot is full and still holds part of a single line
+            Slot->Buffer = line_reader_grow(Slot->Buffer, Filled, &Slot->BufferSize);
+        }
+
+        Pipeline->BytesRead += Filled - CarrySize;
+        Slot->Last           = EndOfStream;
+
+        Carry     = Slot->Buffer + Slot->LinesSize;
+        CarrySize = Filled - Slot->LinesSize;
+
+        f64 ReadEnd = wall_clock_ms();
+        Pipeline->ReadStallMs += ReadBegin - WaitBegin;
+        Pipeline->ReadMs      += ReadEnd - ReadBegin;
+
+        platform_semaphore_post(&Pipeline->FilledSlots);
+        if (EndOfStream) break;
+    }
+
+    return NULL;
+}
+
+file_io_error line_pipeline_run(const char* Filepath, u64 ChunkSize,
+        line_pipeline_fn* Fn, void* Data, line_pipeline_stats* OutStats)
+{
+    line_pipeline Pipeline = { .Error = file_io_none };
+
+    file_io_error Error = platform_open_file_stream(Filepath, &Pipeline.Stream);
+    if (Error != file_io_none)
+        return Error;
+
+    ForRange(int, i, 2)
+    {
+        Pipeline.Slots[i].Buffer     = mem_alloc(char, ChunkSize);
+        Pipeline.Slots[i].BufferSize = ChunkSize;
+    }
+
+    platform_semaphore_init(&Pipeline.FreeSlots, 2);
+    platform_semaphore_init(&Pipeline.FilledSlots, 0);
+
+    line_pipeline_stats Stats = {0};
+    f64 Begin = wall_clock_ms();
+
+    platform_thread Reader;
+    bool Created = platform_thread_create(&Reader, line_pipeline_reader_proc, &Pipeline);
+    cassert(Created);
+
+    for (u64 SlotIndex = 0; ; ++SlotIndex)
+    {
+        line_pipeline_slot* Slot = &Pipeline.Slots[SlotIndex % 2];
+
+        f64 WaitBegin = wall_clock_ms();
+        platform_semaphore_wait(&Pipeline.FilledSlots);
+        f64 ComputeBegin = wall_clock_ms();
+
+        if (Slot->LinesSize > 0)
+        {
+            Fn(Slot->Buffer, Slot->Buffer + Slot->LinesSize, Data);
+            Stats.ChunkCount += 1;
+        }
+        bool Last = Slot->Last;
+
+        f64 ComputeEnd = wall_clock_ms();
+        Stats.ComputeStallMs += ComputeBegin - WaitBegin;
+        Stats.ComputeMs      += ComputeEnd - ComputeBegin;
+
+        platform_semaphore_post(&Pipeline.FreeSlots);
+        if (Last) break;
+    }
+
+    platform_thread_join(&Reader);
+
+    Stats.TotalMs     = wall_clock_ms() - Begin;
+    Stats.ReadMs      = Pipeline.ReadMs;
+    Stats.ReadStallMs = Pipeline.ReadStallMs;
+    Stats.BytesRead   = Pipeline.BytesRead;
+    if (OutStats) *OutStats = Stats;
+
+    platform_semaphore_deinit(&Pipeline.FreeSlots);
+    platform_semaphore_deinit(&Pipeline.FilledSlots);
+    ForRange(int, i, 2)
+        mem_free(Pipeline.Slots[i].Buffer);
+    platform_close_file_stream(&Pipeline.Stream);
+
+    return Pipeline.Error;
+}
@@ -0,0 +1,68 @@
+#ifndef _LINE_READER_H_
+#define _LINE_READER_H_
+
+#include "chibi_types.h"
+#include "platform.h"
+
+//
+// Line Reader
+//
+// Reads a file stream in to a fixed size buffer and hands out the complete lines it holds.
+// The partial line at the end of the buffer is carried over to the front of the buffer
+// before the next read, so peak memory is the chunk size regardless of the input size.
+//
+// A line longer than the chunk size doesn't fit, the buffer is doubled until it does. Lines are
+// never handed out split.
+//
+
+typedef struct
+{
+    platform_file_stream Stream;
+
+    char* Buffer;
+    u64   BufferSize;
+    u64   Filled;   // Bytes of Buffer holding data
+    u64   Consumed; // Bytes of Buffer handed out by the last call to line_reader_next
+
+    bool          EndOfStream;
+    file_io_error Error;
+} line_reader;
+
+// Filepath can be NULL or "-" to read from stdin. Allocates a ChunkSize buffer, which grows if a
+// line doesn't fit in it.
+file_io_error line_reader_open(line_reader* Reader, const char* Filepath, u64 ChunkSize);
+void line_reader_close(line_reader* Reader);
+
+// Returns the next run of complete lines in [*OutStart, *OutEnd). The range stays valid until
+// the next call. Returns false once the stream is exhausted or failed, check Reader->Error.
+bool line_reader_next(line_reader* Reader, char** OutStart, char** OutEnd);
+
+//
+// Pipeline
+//
+// Double buffered version of the line reader. A reader thread fills one chunk while Fn runs
+// on the other on the calling thread, so reading is hidden behind the compute. Fn is called
+// in stream order with complete lines only.
+//
+// The stats report how long each side spent waiting on the other: a large read stall means
+// compute is the bottleneck, a large compute stall means storage is.
+//
+
+typedef void line_pipeline_fn(char* Lines, char* LinesEnd, void* Data);
+
+typedef struct
+{
+    f64 TotalMs;
+    f64 ReadMs;         // Time spent reading
+    f64 ReadStallMs;    // Time the reader waited for a free buffer
+    f64 ComputeMs;      // Time spent in Fn
+    f64 ComputeStallMs; // Time Fn waited for a filled buffer
+    u64 ChunkCount;
+    u64 BytesRead;
+} line_pipeline_stats;
+
+// Allocates two ChunkSize buffers, which grow like the line reader's. OutStats can be NULL.
+file_io_error line_pipeline_run(const char* Filepath, u64 ChunkSize,
+        line_pipeline_fn* Fn, void* Data, line_pipeline_stats* OutStats);
+
+#endif //_LINE_READER_H_
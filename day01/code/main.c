@@ -1,10 +1,23 @@
+// GNU extensions (cpu_set_t, memmem, REG_RIP), needed before the first system include
+#if !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE
+#endif
+
 // -------------------------------------------------------------------
 // Headers
 
 #include "chibi_types.h"
 #include "platform.h"
 #include "chibi_core.h"
+#include "chibi_memory.h"
 #include "darray.h"
+#include "job_system.h"
+#include "line_reader.h"
+#include "pool.h"
+
+#if defined(__SSE2__)
+#  include <immintrin.h>
+#endif
 
 // -------------------------------------------------------------------
 // Implementation
@@ -20,9 +33,10 @@ fn_inline bool is_line_end(char Val)            { return Val == '\r' || Val == '
 fn_inline int  make_number(int Tens, int Zeros) { return (Tens * 10) + Zeros;        }
 fn_inline int  char_to_digit(char Val)          { return Val - '0';                  }
 
+// Reference implementation, compares against each candidate word with string_compare.
 // If not word digit, return -1
 // else returns the digit
-fn_inline int is_word_digit(char* Digit, int Length)
+fn_inline int is_word_digit_compare(char* Digit, int Length)
 {
     switch(Digit[0])
     {
@@ -93,25 +107,13 @@ fn_inline int is_word_digit(char* Digit, int Length)
 // Returns the start of the next line
 fn_inline char* get_line(char* Start, char* StrEnd, char** OutLineEnd, int* OutLineLen)
 {
-    char* Iter = Start;
-    while (Iter < StrEnd)
-    {
-        if (is_line_end(*Iter))
-        {
-            *OutLineEnd  = Start;
-            *OutLineLen = Iter - Start;
-            break;
-        }
+    char* Iter = (char*)string_find_either_byte(Start, StrEnd - Start, '\r', '\n');
+    if (!Iter) Iter = StrEnd;
 
-        Iter += 1;
-    }
+    *OutLineEnd = Start;
+    *OutLineLen = Iter - Start;
 
-    if (Iter == StrEnd)
-    { // This was the last line
-        *OutLineEnd = Start;
-        *OutLineLen = Iter - Start;
-    }
-    else 
+    if (Iter != StrEnd)
     { // Lets go ahead and consume the line endings for the next line
         while (Iter < StrEnd)
         {
@@ -123,7 +125,90 @@ fn_inline char* get_line(char* Start, char* StrEnd, char** OutLineEnd, int* OutL
     return Iter;
 }
 
-fn_inline int parse_line(char* Start, int Length)
+// Digit kernels: classify a block of bytes at once. A byte is a digit when (Byte - '0'), as
+// an unsigned value, is <= 9. The resulting movemask has one bit per byte, so the first digit
+// is the lowest set bit (tzcnt) and the last digit the highest set bit (lzcnt).
+
+#if defined(__AVX2__)
+fn_inline u32 digit_mask_32(char* Start)
+{
+    __m256i Chunk   = _mm256_loadu_si256((__m256i*)Start);
+    __m256i Shifted = _mm256_sub_epi8(Chunk, _mm256_set1_epi8('0'));
+    __m256i IsDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(Shifted, _mm256_set1_epi8(9)), Shifted);
+    return (u32)_mm256_movemask_epi8(IsDigit);
+}
+#endif
+
+#if defined(__SSE2__)
+fn_inline u32 digit_mask_16(char* Start)
+{
+    __m128i Chunk   = _mm_loadu_si128((__m128i*)Start);
+    __m128i Shifted = _mm_sub_epi8(Chunk, _mm_set1_epi8('0'));
+    __m128i IsDigit = _mm_cmpeq_epi8(_mm_min_epu8(Shifted, _mm_set1_epi8(9)), Shifted);
+    return (u32)_mm_movemask_epi8(IsDigit);
+}
+#endif
+
+// Returns the index of the first digit in the line, or -1 if there is none
+fn_inline int find_first_digit(char* Start, int Length)
+{
+    int Index = 0;
+
+#if defined(__AVX2__)
+    for (; Index + 32 <= Length; Index += 32)
+    {
+        u32 Mask = digit_mask_32(Start + Index);
+        if (Mask) return Index + __builtin_ctz(Mask);
+    }
+#endif
+
+#if defined(__SSE2__)
+    for (; Index + 16 <= Length; Index += 16)
+    {
+        u32 Mask = digit_mask_16(Start + Index);
+        if (Mask) return Index + __builtin_ctz(Mask);
+    }
+#endif
+
+    for (; Index < Length; ++Index)
+    {
+        if (is_digit(Start[Index])) return Index;
+    }
+
+    return -1;
+}
+
+// Returns the index of the last digit in the line, or -1 if there is none
+fn_inline int find_last_digit(char* Start, int Length)
+{
+    int Index = Length;
+
+#if defined(__AVX2__)
+    for (; Index >= 32; Index -= 32)
+    {
+        u32 Mask = digit_mask_32(Start + Index - 32);
+        if (Mask) return Index - 1 - __builtin_clz(Mask);
+    }
+#endif
+
+#if defined(__SSE2__)
+    for (; Index >= 16; Index -= 16)
+    {
+        u32 Mask = digit_mask_16(Start + Index - 16) << 16;
+        if (Mask) return Index - 1 - __builtin_clz(Mask);
+    }
+#endif
+
+    for (Index -= 1; Index >= 0; --Index)
+    {
+        if (is_digit(Start[Index])) return Index;
+    }
+
+    return -1;
+}
+
+// Reference implementation, walks the line one byte at a time from both ends.
+fn_inline int parse_line_scalar(char* Start, int Length)
 {
     int Tens  = 0;
     int Zeros = 0;
@@ -159,7 +244,19 @@ fn_inline int parse_line(char* Start, int Length)
     return make_number(Tens, Zeros);
 }
 
-fn_inline int parse_line_with_words(char* Start, int Length)
+fn_inline int parse_line(char* Start, int Length)
+{
+    int First = find_first_digit(Start, Length);
+    if (First < 0) return 0;
+
+    // The last digit can't come before the first one, so only search the remainder
+    int Last = First + find_last_digit(Start + First, Length - First);
+    return make_number(char_to_digit(Start[First]), char_to_digit(Start[Last]));
+}
+
+// Reference implementation, checks for a digit or a spelled out digit at every position
+// from both ends of the line.
+fn_inline int parse_line_with_words_scalar(char* Start, int Length)
 {
     int Tens  = 0;
     int Zeros = 0;
@@ -185,7 +282,7 @@ fn_inline int parse_line_with_words(char* Start, int Length)
             }
             else
             {
-                int Digit = is_word_digit(Start + FrontIndex, Length - i);
+                int Digit = is_word_digit_compare(Start + FrontIndex, Length - i);
                 if (Digit > -1)
                 {
                     FoundTens = true;
@@ -203,7 +300,7 @@ fn_inline int parse_line_with_words(char* Start, int Length)
             }
             else
             {
-                int Digit = is_word_digit(Start + BackIndex, Length - BackIndex);
+                int Digit = is_word_digit_compare(Start + BackIndex, Length - BackIndex);
                 if (Digit > -1)
                 {
                     FoundZeros = true;
@@ -219,20 +316,60 @@ fn_inline int parse_line_with_words(char* Start, int Length)
     return make_number(Tens, Zeros);
 }
 
-int compute_sum(char* Line, char* LineEnd)
+// Part 2 matches digits and spelled out digits in one pass with a pair of automata: a forward
+// one for the first match and a reversed one for the last match. Word ids map to the digit
+// with (Id % 10).
+var_global const char* cDigitWords[] = {
+    "0",    "1",   "2",   "3",     "4",    "5",    "6",   "7",     "8",     "9",
+    "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine",
+};
+
+var_global string_matcher gForwardDigits;
+var_global string_matcher gBackwardDigits;
+
+void digit_matchers_init()
+{
+    gForwardDigits  = string_matcher_build(cDigitWords, ArrayCount(cDigitWords), false);
+    gBackwardDigits = string_matcher_build(cDigitWords, ArrayCount(cDigitWords), true);
+}
+
+void digit_matchers_free()
 {
-    int Sum = 0;
+    string_matcher_free(&gForwardDigits);
+    string_matcher_free(&gBackwardDigits);
+}
 
-    while (Line < LineEnd)
-    {
-        char* CurrentLine    = NULL;
-        int   CurrentLineLen = 0;
+fn_inline int parse_line_with_words(char* Start, int Length)
+{
+    u64 FirstPosition = 0;
+    s32 First = string_matcher_find_first(&gForwardDigits, Start, Length, &FirstPosition);
+    if (First < 0) return 0;
 
-        Line = get_line(Line, LineEnd, &CurrentLine, &CurrentLineLen);
-        cassert(CurrentLine && CurrentLine > 0);
+    // The last match can't start before the first one, so only scan the remainder
+    u64 LastPosition = 0;
+    s32 Last = string_matcher_find_last(&gBackwardDigits, Start + FirstPosition, Length - FirstPosition, &LastPosition);
+    cassert(Last >= 0);
 
-        int LineNumber = parse_line(CurrentLine, CurrentLineLen);
+    return make_number(First % 10, Last % 10);
+}
+
+// Reference implementation, splits the input in to lines with a str_view and parses one line
+// at a time.
+s64 compute_sum_lines(char* Line, char* LineEnd)
+{
+    s64 Sum = 0;
+
+    str_view Input = str_view_from_range(Line, LineEnd);
+    str_view CurrentLine;
+    while (str_view_next_line(&Input, &CurrentLine))
+    {
+        if (CurrentLine.Length == 0) continue; // Blank line
+
+        int LineNumber = parse_line((char*)CurrentLine.Data, (int)CurrentLine.Length);
         //log_debug("Line Number %d", LineNumber);
+#if defined(DEBUG_BUILD)
+        cassert(LineNumber == parse_line_scalar((char*)CurrentLine.Data, (int)CurrentLine.Length));
+#endif
 
         Sum += LineNumber;
     }
@@ -240,9 +377,142 @@ int compute_sum(char* Line, char* LineEnd)
     return Sum;
 }
 
-int compute_sum_extra(char* Line, char* LineEnd)
+// -------------------------------------------------------------------
+// Two stage indexer
+//
+// Stage 1 sweeps the input in 64 byte blocks and emits two bitmasks per block: one bit for
+// every line ending and one bit for every digit. Stage 2 walks the masks and pulls out the
+// first and last digit of each line with ctz/clz, without scanning the bytes again.
+//
+// Input is processed in batches of INDEX_BATCH_BLOCKS blocks so the masks written by
+// stage 1 are still in L1 when stage 2 reads them.
+
+#define INDEX_BLOCK_SIZE   64
+#define INDEX_BATCH_BLOCKS 64
+
+typedef struct
 {
-    int Sum = 0;
+    u64 LineEnds;
+    u64 Digits;
+} block_masks;
+
+fn_inline block_masks index_block(char* Block)
+{
+    block_masks Result = {0};
+
+#if defined(__AVX2__)
+    __m256i Lo = _mm256_loadu_si256((__m256i*)(Block +  0));
+    __m256i Hi = _mm256_loadu_si256((__m256i*)(Block + 32));
+
+    __m256i NewLine = _mm256_set1_epi8('\n');
+    __m256i Return  = _mm256_set1_epi8('\r');
+    u64 EndsLo = (u32)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(Lo, NewLine), _mm256_cmpeq_epi8(Lo, Return)));
+    u64 EndsHi = (u32)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(Hi, NewLine), _mm256_cmpeq_epi8(Hi, Return)));
+
+    Result.LineEnds = EndsLo | (EndsHi << 32);
+    Result.Digits   = (u64)digit_mask_32(Block) | ((u64)digit_mask_32(Block + 32) << 32);
+#elif defined(__SSE2__)
+    __m128i NewLine = _mm_set1_epi8('\n');
+    __m128i Return  = _mm_set1_epi8('\r');
+    ForRange(int, i, 4)
+    {
+        __m128i Chunk = _mm_loadu_si128((__m128i*)(Block + i * 16));
+        u64 Ends = (u32)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(Chunk, NewLine), _mm_cmpeq_epi8(Chunk, Return)));
+
+        Result.LineEnds |= Ends << (i * 16);
+        Result.Digits   |= (u64)digit_mask_16(Block + i * 16) << (i * 16);
+    }
+#else
+    ForRange(int, i, INDEX_BLOCK_SIZE)
+    {
+        Result.LineEnds |= (u64)is_line_end(Block[i]) << i;
+        Result.Digits   |= (u64)is_digit(Block[i])    << i;
+    }
+#endif
+
+    return Result;
+}
+
+typedef struct
+{
+    s64 Sum;
+    int First; // -1 when the current line has not seen a digit yet
+    int Last;
+} index_state;
+
+// Stage 2 for a single block.
+fn_inline void walk_block(index_state* State, char* Block, block_masks Masks)
+{
+    u64 Digits = Masks.Digits;
+    u64 Ends   = Masks.LineEnds;
+
+    while (Ends)
+    {
+        u64 BeforeEnd  = (Ends & -Ends) - 1; // every bit below the next line ending
+        u64 LineDigits = Digits & BeforeEnd;
+
+        if (LineDigits)
+        {
+            if (State->First < 0) State->First = char_to_digit(Block[__builtin_ctzll(LineDigits)]);
+            State->Last = char_to_digit(Block[63 - __builtin_clzll(LineDigits)]);
+        }
+
+        if (State->First >= 0) State->Sum += make_number(State->First, State->Last);
+        State->First = -1;
+
+        Digits &= ~BeforeEnd;
+        Ends   &= Ends - 1;
+    }
+
+    // Whatever remains belongs to a line that continues into the next block
+    if (Digits)
+    {
+        if (State->First < 0) State->First = char_to_digit(Block[__builtin_ctzll(Digits)]);
+        State->Last = char_to_digit(Block[63 - __builtin_clzll(Digits)]);
+    }
+}
+
+s64 compute_sum(char* Line, char* LineEnd)
+{
+    index_state State = { .Sum = 0, .First = -1, .Last = 0 };
+    block_masks Masks[INDEX_BATCH_BLOCKS];
+
+    u64 FullBlocks = (u64)(LineEnd - Line) / INDEX_BLOCK_SIZE;
+    for (u64 Batch = 0; Batch < FullBlocks; Batch += INDEX_BATCH_BLOCKS)
+    {
+        char* BatchStart = Line + Batch * INDEX_BLOCK_SIZE;
+        u64   BlockCount = FullBlocks - Batch;
+        if (BlockCount > INDEX_BATCH_BLOCKS) BlockCount = INDEX_BATCH_BLOCKS;
+
+        // Stage 1
+        ForRange(u64, i, BlockCount)
+            Masks[i] = index_block(BatchStart + i * INDEX_BLOCK_SIZE);
+
+        // Stage 2
+        ForRange(u64, i, BlockCount)
+            walk_block(&State, BatchStart + i * INDEX_BLOCK_SIZE, Masks[i]);
+    }
+
+    // The trailing partial block is copied into a zero padded block, zero is neither a
+    // digit nor a line ending so the padding doesn't produce any bits.
+    char* Tail     = Line + FullBlocks * INDEX_BLOCK_SIZE;
+    u64   TailSize = (u64)(LineEnd - Tail);
+    if (TailSize > 0)
+    {
+        char Padded[INDEX_BLOCK_SIZE] = {0};
+        mem_copy(Padded, Tail, TailSize);
+        walk_block(&State, Padded, index_block(Padded));
+    }
+
+    // The last line might not have a line ending
+    if (State.First >= 0) State.Sum += make_number(State.First, State.Last);
+
+    return State.Sum;
+}
+
+s64 compute_sum_extra(char* Line, char* LineEnd)
+{
+    s64 Sum = 0;
 
     while (Line < LineEnd)
     {
@@ -254,6 +524,9 @@ int compute_sum_extra(char* Line, char* LineEnd)
 
         int LineNumber = parse_line_with_words(CurrentLine, CurrentLineLen);
         //log_debug("Line Number %d", LineNumber);
+#if defined(DEBUG_BUILD)
+        cassert(LineNumber == parse_line_with_words_scalar(CurrentLine, CurrentLineLen));
+#endif
 
         Sum += LineNumber;
     }
@@ -261,11 +534,81 @@ int compute_sum_extra(char* Line, char* LineEnd)
     return Sum;
 }
 
+// -------------------------------------------------------------------
+// Parallel sum
+//
+// The input is cut in to fixed size chunks which are summed as jobs, idle workers steal
+// chunks from busy ones so uneven line lengths balance out. Chunk boundaries are moved
+// forward to the start of the next line so no line is split between two chunks. Every
+// chunk computes its boundaries the same way, so the chunks still cover the input exactly.
+
+#define SUM_CHUNK_SIZE _64KB
+
+typedef s64 compute_sum_fn(char* Line, char* LineEnd);
+
+typedef struct
+{
+    compute_sum_fn* ComputeSum;
+    char*           Start;
+    char*           End;
+    s64 volatile    Sum;
+} sum_chunks;
+
+// Returns the start of the line after the one Iter is in, or StrEnd if that line doesn't end
+// before Limit.
+fn_inline char* snap_to_next_line(char* Iter, char* Limit, char* StrEnd)
+{
+    while (Iter < Limit  && !is_line_end(*Iter)) Iter += 1;
+    if (Iter == Limit) return StrEnd;
+    while (Iter < StrEnd &&  is_line_end(*Iter)) Iter += 1;
+    return Iter;
+}
+
+fn_inline char* chunk_offset(sum_chunks* Chunks, u64 ChunkIndex)
+{
+    u64 Offset = ChunkIndex * SUM_CHUNK_SIZE;
+    if (Offset >= (u64)(Chunks->End - Chunks->Start)) return Chunks->End;
+    return Chunks->Start + Offset;
+}
+
+fn_internal void sum_chunks_proc(u64 FirstChunk, u64 EndChunk, void* Data)
+{
+    sum_chunks* Chunks = (sum_chunks*)Data;
+
+    // The start only has to be searched for up to the end of the range. If the line doesn't end
+    // before then, the end boundary snaps to the same place and the range is empty. This keeps
+    // a line much longer than a chunk from being scanned once per chunk it covers.
+    char* RangeStart = chunk_offset(Chunks, FirstChunk);
+    char* RangeEnd   = chunk_offset(Chunks, EndChunk);
+
+    char* Start = (FirstChunk == 0) ? Chunks->Start : snap_to_next_line(RangeStart, RangeEnd, Chunks->End);
+    if (Start >= Chunks->End) return; // a single line covers the whole range
+
+    char* End = snap_to_next_line(RangeEnd, Chunks->End, Chunks->End);
+
+    atomic_fetch_add_s64(&Chunks->Sum, Chunks->ComputeSum(Start, End));
+}
+
+s64 compute_sum_parallel(char* Line, char* LineEnd, compute_sum_fn* ComputeSum)
+{
+    sum_chunks Chunks = {
+        .ComputeSum = ComputeSum,
+        .Start      = Line,
+        .End        = LineEnd,
+        .Sum        = 0,
+    };
+
+    u64 ChunkCount = DivideAlign((u64)(LineEnd - Line), SUM_CHUNK_SIZE);
+    parallel_for(0, ChunkCount, 1, sum_chunks_proc, &Chunks);
+
+    return Chunks.Sum;
+}
+
 void run_part1()
 {
     char* Line;
     char* InputEnd;
-    int Sum = 0;
+    s64 Sum = 0;
 
 #if 0
     char* Sample = 
@@ -286,26 +629,34 @@ void run_part1()
 #endif
 
     // Test the second example input
-    file_io_read_result Result = platform_read_entire_file("input_p1.txt");
-    cassert(Result.Error == file_io_none);
+    file_io_read_result Input = platform_map_file("input_p1.txt", file_map_populate | file_map_sequential);
+    cassert(Input.Error == file_io_none);
 
-    clock_t Begin = clock();
+    f64 Begin = wall_clock_ms();
 
-    Line = Result.FileData;
-    InputEnd = Result.FileData + Result.FileSize;
-    Sum = compute_sum(Line, InputEnd);
+    Line = Input.FileData;
+    InputEnd = Input.FileData + Input.FileSize;
+    Sum = compute_sum_parallel(Line, InputEnd, compute_sum);
+
+    f64 End = wall_clock_ms();
 
-    clock_t End = clock();
+#if defined(DEBUG_BUILD)
+    cassert(Sum == compute_sum_lines(Line, InputEnd));
+#endif
 
-    log_info("FINAL SUM PART 1: %d", Sum);
-    log_info("Part 1 Timing: %lf", clock_ms(Begin, End));
+    log_info("FINAL SUM PART 1: %ld", Sum);
+    log_info("Part 1 Timing: %lf", End - Begin);
+
+    platform_unmap_file(&Input);
 }
 
 void run_part2()
 {
     char* Line;
     char* InputEnd;
-    int Sum = 0;
+    s64 Sum = 0;
+
+    digit_matchers_init();
 
 #if 0
     char* Sample = 
@@ -325,35 +676,126 @@ void run_part2()
 
     // First example input
     Sum = compute_sum_extra(Line, InputEnd);
-    log_info("Sample sum: %d", Sum);
+    log_info("Sample sum: %ld", Sum);
     cassert(Sum == 281);
 #endif
 
     // FINAL INPUT
 
-    file_io_read_result Result = platform_read_entire_file("input_p2.txt");
-    cassert(Result.Error == file_io_none);
+    file_io_read_result Input = platform_map_file("input_p2.txt", file_map_populate | file_map_sequential);
+    cassert(Input.Error == file_io_none);
 
-    clock_t Begin = clock();
+    f64 Begin = wall_clock_ms();
 
-    Line = Result.FileData;
-    InputEnd = Result.FileData + Result.FileSize;
-    Sum = compute_sum_extra(Line, InputEnd);
+    Line = Input.FileData;
+    InputEnd = Input.FileData + Input.FileSize;
+    Sum = compute_sum_parallel(Line, InputEnd, compute_sum_extra);
+
+    f64 End = wall_clock_ms();
+
+    log_info("FINAL SUM PART 2: %ld", Sum);
+    log_info("Part 2 Timing: %lf", End - Begin);
+
+    platform_unmap_file(&Input);
+
+    digit_matchers_free();
+}
+
+// Streams the input through a pair of fixed size buffers instead of loading it, so the input
+// can be larger than memory or come from a pipe. A reader thread fills one buffer while the
+// workers sum the other. Both parts are computed in the same pass since stdin can only be
+// read once.
+#define STREAM_CHUNK_SIZE _8MB
+
+typedef struct
+{
+    s64 SumPart1;
+    s64 SumPart2;
+} stream_sums;
 
-    clock_t End = clock();
+fn_internal void sum_stream_chunk(char* Lines, char* LinesEnd, void* Data)
+{
+    stream_sums* Sums = (stream_sums*)Data;
+    Sums->SumPart1 += compute_sum_parallel(Lines, LinesEnd, compute_sum);
+    Sums->SumPart2 += compute_sum_parallel(Lines, LinesEnd, compute_sum_extra);
+}
+
+void run_stream(const char* Filepath)
+{
+    digit_matchers_init();
+
+    stream_sums Sums = {0};
+    line_pipeline_stats Stats = {0};
+
+    file_io_error Error = line_pipeline_run(Filepath, STREAM_CHUNK_SIZE, sum_stream_chunk, &Sums, &Stats);
+    if (Error != file_io_none)
+    { // The sums only cover part of the input
+        log_error("Failed to stream %s, error: %d", Filepath, Error);
+        digit_matchers_free();
+        return;
+    }
+
+    log_info("FINAL SUM PART 1: %ld", Sums.SumPart1);
+    log_info("FINAL SUM PART 2: %ld", Sums.SumPart2);
+    log_info("Stream Timing: %lf (%lu chunks, %lu bytes)", Stats.TotalMs, Stats.ChunkCount, Stats.BytesRead);
+    log_info("    Read:    %lf, stalled %lf", Stats.ReadMs, Stats.ReadStallMs);
+    log_info("    Compute: %lf, stalled %lf", Stats.ComputeMs, Stats.ComputeStallMs);
 
-    log_info("FINAL SUM PART 2: %d", Sum);
-    log_info("Part 2 Timing: %lf", clock_ms(Begin, End));
+    digit_matchers_free();
 }
 
-int main(void)
+#if defined(BENCHMARK_BUILD)
+#  include "benchmarks.c"
+#endif
+
+// Usage: advent [thread count] [input file]
+//
+// The thread count defaults to the number of cores. When an input file is given ("-" for
+// stdin) it is streamed through both parts instead of running on input_p1/p2.txt.
+int main(int ArgCount, char** Args)
 {
+    // Every allocation for the run comes out of a single arena, or the heap if it can't be reserved
+    memory_arena Arena = arena_init(ARENA_DEFAULT_RESERVE_SIZE);
+    if (Arena.Base)
+        chibi_memory_bind_arena(&Arena);
+
     s64 LoggerSize = logger_get_mem_requirements();
     void* Logger = mem_alloc(byte, LoggerSize);
     logger_initialize(Logger);
 
-    run_part1();
-    run_part2();
+    if (!Arena.Base)
+        log_warn("Failed to reserve the memory arena, allocating from the heap instead.");
+
+    u32 ThreadCount = platform_thread_get_core_count();
+    if (ArgCount > 1)
+    {
+        s32 RequestedCount = 0;
+        if (string_to_int(Args[1], &RequestedCount) && RequestedCount > 0)
+            ThreadCount = (u32)RequestedCount;
+        else
+            log_warn("Invalid thread count \"%s\", using %u thread(s).", Args[1], ThreadCount);
+    }
+
+    job_system_init(ThreadCount);
+
+#if defined(BENCHMARK_BUILD)
+    run_benchmarks();
+#else
+    if (ArgCount > 2)
+    {
+        run_stream(Args[2]);
+    }
+    else
+    { // The inputs are mapped rather than read, see platform_map_file
+        run_part1();
+        run_part2();
+    }
+#endif
+
+    job_system_shutdown();
+
+    chibi_memory_bind_arena(NULL);
+    arena_release(&Arena);
 
     return 0;
 }
@@ -362,5 +804,9 @@ int main(void)
 // Source Code from ther files
 
 #include "chibi_core.c" 
+#include "chibi_memory.c"
 #include "darray.c"
+#include "job_system.c"
+#include "line_reader.c"
+#include "pool.c"
 #include "platform_unix.c"
\ No newline at end of file
@@ -1,4 +1,11 @@
 
+// GNU extensions for thread affinity (cpu_set_t, pthread_setaffinity_np) and the crash
+// reporter's register names. _GNU_SOURCE has to be defined before the first system include
+// to take effect, in the unity build that is the top of main.c.
+#if !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE
+#endif
+
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -6,6 +13,10 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
 
 #include <assert.h> //assert
 #include <stdio.h>  //printf
@@ -62,8 +73,9 @@ var_global const char* cConfigEnv = "XDG_CONFIG_HOME";
 var_global const char* cCacheEnv  = "XDG_CACHE_HOME";
 var_global const char* cHomeEnv   = "HOME";
 
+// Builds $HOME/LocalPath in the given arena
 fn_internal char*
-unix_build_home_dir(const char* LocalPath)
+unix_build_home_dir(memory_arena* Arena, const char* LocalPath)
 {
     const char* HomeDir =  getenv(cHomeEnv);
     if (!HomeDir) return NULL;
@@ -71,124 +83,83 @@ unix_build_home_dir(const char* LocalPath)
     u64 HomeLen = string_len(HomeDir);
     u64 LocalLen = string_len(LocalPath);
     u64 DesiredStringLen = HomeLen + LocalLen + 1;
-    char* Result = mem_alloc(char, DesiredStringLen);
+    char* Result = arena_push_array(Arena, char, DesiredStringLen);
 
     string_concat(
             Result,    DesiredStringLen, 
             HomeDir,   HomeLen, 
             LocalPath, LocalLen);
+    Result[HomeLen + LocalLen] = 0;
 
     return Result;
 }
 
-char* platform_get_config_dir()
+// Allocates a copy of Dir, appending a / if it doesn't end with one already
+fn_internal char*
+unix_duplicate_dir(const char* Dir)
 {
-    char* Result = NULL;
-    
-    const char* ConfigDir = getenv(cConfigEnv);
-    if (ConfigDir)
-    {
-        Result = string_duplicate(ConfigDir);
-    }
-
-    if (!Result)
-    { // Failed to get the config env variable, let's try the home variable
-        Result = unix_build_home_dir("/.config/chibi-tech");
-    }
+    u64 Len = string_len(Dir);
+    bool NeedsSlash = (Len == 0) || (Dir[Len - 1] != '/');
 
-    if (!Result)
-    { // Failed to get the home variable, let's just use the local path then...
-        Result = string_duplicate(".");
-    }
-
-    if (Result && Result[string_len(Result) - 1] != '/')
-    { // let's append /
-        char* Interim = Result; 
-        int Len = string_len(Interim);
-
-        Result = mem_alloc(char, Len + 2);
-        string_concat(
-                Result,  Len + 2,
-                Interim, Len,
-                "/",     1);
-
-        mem_free(Interim);
-    }
+    char* Result = mem_alloc(char, Len + 2);
+    string_concat(
+            Result, Len + 2,
+            Dir,    Len,
+            "/",    NeedsSlash ? 1 : 0);
+    Result[Len + (NeedsSlash ? 1 : 0)] = 0;
 
     return Result;
 }
 
-char* platform_get_data_dir()
+char* platform_get_config_dir()
 {
-    char* Result = NULL;
-    
-    const char *DataDir = getenv(cDataEnv);
-    if (DataDir)
-    {
-        Result = string_duplicate(DataDir);
-    }
+    arena_marker Scratch = scratch_begin(NULL, 0);
 
-    if (!Result)
+    const char* ConfigDir = getenv(cConfigEnv);
+    if (!ConfigDir)
     { // Failed to get the config env variable, let's try the home variable
-        Result = unix_build_home_dir("/.local/chibi-tech");
+        ConfigDir = unix_build_home_dir(Scratch.Arena, "/.config/chibi-tech");
     }
 
-    if (!Result)
+    if (!ConfigDir)
     { // Failed to get the home variable, let's just use the local path then...
-        Result = platform_get_config_dir();
+        ConfigDir = ".";
     }
 
-    if (Result && Result[string_len(Result) - 1] != '/')
-    { // let's append /
-        char* Interim = Result; 
-        int Len = string_len(Interim);
+    char* Result = unix_duplicate_dir(ConfigDir);
+    scratch_end(Scratch);
+    return Result;
+}
 
-        Result = mem_alloc(char, Len + 2);
-        string_concat(
-                Result,  Len + 2,
-                Interim, Len,
-                "/",     1);
+char* platform_get_data_dir()
+{
+    arena_marker Scratch = scratch_begin(NULL, 0);
 
-        mem_free(Interim);
+    const char* DataDir = getenv(cDataEnv);
+    if (!DataDir)
+    { // Failed to get the config env variable, let's try the home variable
+        DataDir = unix_build_home_dir(Scratch.Arena, "/.local/chibi-tech");
     }
 
+    // Failed to get the home variable, let's just use the config path then...
+    char* Result = DataDir ? unix_duplicate_dir(DataDir) : platform_get_config_dir();
+    scratch_end(Scratch);
     return Result;
 }
 
 char* platform_get_cache_dir()
 {
-    char* Result = NULL;
-    
-    const char *CacheDir = getenv(cCacheEnv);
-    if (CacheDir)
-    {
-        Result = string_duplicate(CacheDir);
-    }
+    arena_marker Scratch = scratch_begin(NULL, 0);
 
-    if (!Result)
+    const char* CacheDir = getenv(cCacheEnv);
+    if (!CacheDir)
     { // Failed to get the config env variable, let's try the home variable
-        Result = unix_build_home_dir("/.cache/chibi-tech");
-    }
-
-    if (!Result)
-    { // Failed to get the home variable, let's just use the local path then...
-        Result = platform_get_config_dir();
-    }
-
-    if (Result && Result[string_len(Result) - 1] != '/')
-    { // let's append /
-        char* Interim = Result; 
-        int Len = string_len(Interim);
-
-        Result = mem_alloc(char, Len + 2);
-        string_concat(
-                Result,  Len + 2,
-                Interim, Len,
-                "/",     1);
-
-        mem_free(Interim);
+        CacheDir = unix_build_home_dir(Scratch.Arena, "/.cache/chibi-tech");
     }
 
+    // Failed to get the home variable, let's just use the config path then...
+    char* Result = CacheDir ? unix_duplicate_dir(CacheDir) : platform_get_config_dir();
+    scratch_end(Scratch);
     return Result;
 }
 
@@ -269,6 +240,111 @@ LBL_ERROR:
     return Result;
 }
 
+file_io_read_result platform_map_file(const char* Filepath, int MapFlags)
+{
+    file_io_read_result Result = {
+        .Error    = file_io_none,
+        .FileData = NULL,
+    };
+
+    int FilePtr = open(Filepath, O_RDONLY);
+    if (FilePtr == -1)
+    {
+        Result.Error = file_io_file_not_found;
+        goto LBL_ERROR;
+    }
+
+    struct stat FileInfo;
+    if (fstat(FilePtr, &FileInfo) == -1 || !S_ISREG(FileInfo.st_mode))
+    {
+        Result.Error = file_io_wrong_file_type;
+        goto LBL_CLOSE;
+    }
+
+    if (FileInfo.st_size == 0)
+    { // mmap can't map an empty range
+        Result.Error = file_io_file_not_found;
+        goto LBL_CLOSE;
+    }
+
+    int Flags = MAP_PRIVATE;
+    if (MapFlags & file_map_populate) Flags |= MAP_POPULATE;
+
+    void* FileData = mmap(NULL, FileInfo.st_size, PROT_READ, Flags, FilePtr, 0);
+    if (FileData == MAP_FAILED)
+    {
+        Result.Error = file_io_failed_to_read;
+        goto LBL_CLOSE;
+    }
+
+    if (MapFlags & file_map_sequential)
+        madvise(FileData, FileInfo.st_size, MADV_SEQUENTIAL);
+
+    Result.FileData = FileData;
+    Result.FileSize = FileInfo.st_size;
+
+LBL_CLOSE:
+    { // The mapping keeps its own reference to the file
+        int CloseResult = close(FilePtr);
+        cassert_custom(CloseResult != -1, "Failed to close a file opened for mapping.");
+    }
+
+LBL_ERROR:
+    return Result;
+}
+
+void platform_unmap_file(file_io_read_result* MappedFile)
+{
+    if (!MappedFile->FileData) return;
+
+    int Result = munmap(MappedFile->FileData, MappedFile->FileSize);
+    cassert(Result == 0);
+
+    MappedFile->FileData = NULL;
+    MappedFile->FileSize = 0;
+}
+
+file_io_error platform_open_file_stream(const char* Filepath, platform_file_stream* OutStream)
+{
+    if (!Filepath || string_compare(Filepath, string_len(Filepath), "-", 1))
+    {
+        OutStream->Handle     = STDIN_FILENO;
+        OutStream->OwnsHandle = false;
+        return file_io_none;
+    }
+
+    int FilePtr = open(Filepath, O_RDONLY);
+    if (FilePtr == -1)
+        return platform_file_exists(Filepath) ? file_io_failed_to_open : file_io_file_not_found;
+
+    OutStream->Handle     = FilePtr;
+    OutStream->OwnsHandle = true;
+    return file_io_none;
+}
+
+s64 platform_read_file_stream(platform_file_stream* Stream, void* Buffer, u64 BufferSize)
+{
+    ssize_t ReadBytes;
+    do
+    {
+        ReadBytes = read(Stream->Handle, Buffer, BufferSize);
+    } while (ReadBytes == -1 && errno == EINTR);
+
+    return (s64)ReadBytes;
+}
+
+void platform_close_file_stream(platform_file_stream* Stream)
+{
+    if (Stream->OwnsHandle)
+    {
+        int CloseResult = close(Stream->Handle);
+        cassert_custom(CloseResult != -1, "Failed to close a file opened for streaming.");
+    }
+
+    Stream->Handle     = -1;
+    Stream->OwnsHandle = false;
+}
+
 file_io_error platform_write_entire_file(const char* Filepath, void* FileData, u64 NumBytesToWrite, bool Append)
 {
     file_io_error Result = file_io_none;
@@ -353,10 +429,8 @@ void* platform_virtual_reserve_memory(u64 Size)
     Size = forward_align(Size, platform_get_page_size()); 
 
     void* Result = mmap(NULL, Size, ProtectionFlags, Flags, -1, 0);
-    cassert(Result != (void*)-1); 
-    // TODO(enlynn): Properly error check failure
-
-    return Result;
+    // Doesn't log, the logger's scratch arenas are reserved through here
+    return (Result != MAP_FAILED) ? Result : NULL;
 }
 
 void platform_virtual_map_to_physical(void* BasePtr, u64 Offset, u64 PageRange)
@@ -412,10 +486,172 @@ void* platform_load_function(void* Library, const char* FunctionName)
 }
 
 //
-// Crash Reporter
+// Threads
 //
 
-#define __USE_GNU
+_Static_assert(sizeof(pthread_t)       <= sizeof(platform_thread),             "platform_thread is too small");
+_Static_assert(sizeof(pthread_mutex_t) <= sizeof(platform_mutex),              "platform_mutex is too small");
+_Static_assert(sizeof(pthread_cond_t)  <= sizeof(platform_condition_variable), "platform_condition_variable is too small");
+_Static_assert(sizeof(sem_t)           <= sizeof(platform_semaphore),          "platform_semaphore is too small");
+_Static_assert(sizeof(pthread_key_t)   <= sizeof(platform_tls),                "platform_tls is too small");
+
+bool platform_thread_create(platform_thread* Thread, platform_thread_proc* Proc, void* Data)
+{
+    int Result = pthread_create((pthread_t*)&Thread->Handle, NULL, Proc, Data);
+    if (Result != 0)
+    {
+        log_error("Failed to create a thread, error code: %d", Result);
+        return false;
+    }
+    return true;
+}
+
+void* platform_thread_join(platform_thread* Thread)
+{
+    void* Result = NULL;
+    int JoinResult = pthread_join((pthread_t)Thread->Handle, &Result);
+    cassert_custom(JoinResult == 0, "Failed to join a thread.");
+    return Result;
+}
+
+platform_thread platform_thread_current()
+{
+    platform_thread Result = { .Handle = (u64)pthread_self() };
+    return Result;
+}
+
+void platform_thread_yield()
+{
+    sched_yield();
+}
+
+u32 platform_thread_get_core_count()
+{
+    long Count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (Count > 0) ? (u32)Count : 1;
+}
+
+bool platform_thread_set_affinity(platform_thread* Thread, u32 CoreIndex)
+{
+    cpu_set_t CpuSet;
+    CPU_ZERO(&CpuSet);
+    CPU_SET(CoreIndex, &CpuSet);
+
+    int Result = pthread_setaffinity_np((pthread_t)Thread->Handle, sizeof(cpu_set_t), &CpuSet);
+    return Result == 0;
+}
+
+void platform_mutex_init(platform_mutex* Mutex)
+{
+    int Result = pthread_mutex_init((pthread_mutex_t*)Mutex, NULL);
+    cassert(Result == 0);
+}
+
+void platform_mutex_deinit(platform_mutex* Mutex)
+{
+    pthread_mutex_destroy((pthread_mutex_t*)Mutex);
+}
+
+void platform_mutex_lock(platform_mutex* Mutex)
+{
+    int Result = pthread_mutex_lock((pthread_mutex_t*)Mutex);
+    cassert(Result == 0);
+}
+
+bool platform_mutex_try_lock(platform_mutex* Mutex)
+{
+    return pthread_mutex_trylock((pthread_mutex_t*)Mutex) == 0;
+}
+
+void platform_mutex_unlock(platform_mutex* Mutex)
+{
+    int Result = pthread_mutex_unlock((pthread_mutex_t*)Mutex);
+    cassert(Result == 0);
+}
+
+void platform_condition_variable_init(platform_condition_variable* ConditionVariable)
+{
+    int Result = pthread_cond_init((pthread_cond_t*)ConditionVariable, NULL);
+    cassert(Result == 0);
+}
+
+void platform_condition_variable_deinit(platform_condition_variable* ConditionVariable)
+{
+    pthread_cond_destroy((pthread_cond_t*)ConditionVariable);
+}
+
+void platform_condition_variable_wait(platform_condition_variable* ConditionVariable, platform_mutex* Mutex)
+{
+    int Result = pthread_cond_wait((pthread_cond_t*)ConditionVariable, (pthread_mutex_t*)Mutex);
+    cassert(Result == 0);
+}
+
+void platform_condition_variable_signal(platform_condition_variable* ConditionVariable)
+{
+    pthread_cond_signal((pthread_cond_t*)ConditionVariable);
+}
+
+void platform_condition_variable_broadcast(platform_condition_variable* ConditionVariable)
+{
+    pthread_cond_broadcast((pthread_cond_t*)ConditionVariable);
+}
+
+void platform_semaphore_init(platform_semaphore* Semaphore, u32 InitialCount)
+{
+    int Result = sem_init((sem_t*)Semaphore, 0, InitialCount);
+    cassert(Result == 0);
+}
+
+void platform_semaphore_deinit(platform_semaphore* Semaphore)
+{
+    sem_destroy((sem_t*)Semaphore);
+}
+
+void platform_semaphore_wait(platform_semaphore* Semaphore)
+{
+    // sem_wait can be interrupted by a signal, in which case we just wait again
+    int Result;
+    do
+    {
+        Result = sem_wait((sem_t*)Semaphore);
+    } while (Result == -1 && errno == EINTR);
+    cassert_custom(Result == 0, "Failed to wait on a semaphore.");
+}
+
+void platform_semaphore_post(platform_semaphore* Semaphore)
+{
+    int Result = sem_post((sem_t*)Semaphore);
+    cassert(Result == 0);
+}
+
+bool platform_tls_alloc(platform_tls* Slot)
+{
+    pthread_key_t Key;
+    if (pthread_key_create(&Key, NULL) != 0)
+        return false;
+
+    Slot->Handle = (u64)Key;
+    return true;
+}
+
+void platform_tls_free(platform_tls* Slot)
+{
+    pthread_key_delete((pthread_key_t)Slot->Handle);
+}
+
+void platform_tls_set(platform_tls* Slot, void* Value)
+{
+    pthread_setspecific((pthread_key_t)Slot->Handle, Value);
+}
+
+void* platform_tls_get(platform_tls* Slot)
+{
+    return pthread_getspecific((pthread_key_t)Slot->Handle);
+}
+
+//
+// Crash Reporter
+//
 
 #include <sys/mman.h>
 #include <unistd.h>
@@ -19,4 +19,4 @@ fi
 
 echo Building in $MODE mode.
 
-clang $FLAGS code/main.c -o advent
\ No newline at end of file
+clang $FLAGS code/main.c -o advent -lpthread
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include "chibi_core.h"
+#include "chibi_memory.h"
 #include "platform.h"
 
 #include <assert.h>
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 void report_assertion_failure(const char* Condition, const char* File, int Line, const char* Message)
 {
     logger_log(log_level_error, File, Line, "Assertion Failure: %s. Message: %s.", Condition, Message);
@@ -79,15 +84,19 @@ void logger_log(int LogLevel, const char* File, int Line, const char* Fmt, ...)
     // Allocate the log memory, and fill out the log 
     // Format: Header: Message\n
     int TotalLogSize = LogHeaderSize + LogSize + 1;
-    cassert(TotalLogSize < 2047);
 
-    char Message[2048];
-    mem_zero(Message, sizeof(Message));
+    arena_marker Scratch = scratch_begin(NULL, 0);
+    char* Message = arena_push_array(Scratch.Arena, char, TotalLogSize + 1);
+    if (!Message)
+    {
+        scratch_end(Scratch);
+        return;
+    }
 
-    LogHeaderSize = string_format(Message, 2048, LogHeader, 0, LogLevelStrings[LogLevel], File, Line); 
+    LogHeaderSize = string_format(Message, TotalLogSize + 1, LogHeader, 0, LogLevelStrings[LogLevel], File, Line); 
     
     va_start(Args, Fmt);
-    string_vformat(Message + LogHeaderSize, 2048, Fmt, Args);
+    string_vformat(Message + LogHeaderSize, TotalLogSize + 1 - LogHeaderSize, Fmt, Args);
     va_end(Args);
 
     Message[TotalLogSize - 1] = '\n';
@@ -102,6 +111,8 @@ void logger_log(int LogLevel, const char* File, int Line, const char* Fmt, ...)
     if ((gState->LogMode & log_mode_file) != 0)
         platform_log_to_file(Message, TotalLogSize, LogLevel);
 
+    scratch_end(Scratch);
+
     if (LogLevel == log_level_fatal)
         platform_debug_break();
 }
@@ -110,6 +121,7 @@ void logger_log(int LogLevel, const char* File, int Line, const char* Fmt, ...)
 #include <ctype.h> //isspace
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
 
 u64 string_len(const char* String)
 {
@@ -148,13 +160,127 @@ bool string_compare(
     if (SourceASize != SourceBSize) 
         return false;
 
-    for (s64 Index = 0; Index < SourceASize; ++Index)
+    return memory_equal(SourceA, SourceB, SourceASize);
+}
+
+// The searches compare STRING_SCAN_WIDTH bytes at a time, 32 with AVX2 and 16 with SSE2
+#if defined(__AVX2__)
+#  define STRING_SCAN_WIDTH 32
+typedef __m256i string_scan_byte;
+
+fn_inline string_scan_byte string_scan_splat(char Byte) { return _mm256_set1_epi8(Byte); }
+
+// Bit i is set if byte i of the STRING_SCAN_WIDTH at String is Byte
+fn_inline u32
+string_match_mask(const char* String, string_scan_byte Byte)
+{
+    return (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)String), Byte));
+}
+#elif defined(__SSE2__)
+#  define STRING_SCAN_WIDTH 16
+typedef __m128i string_scan_byte;
+
+fn_inline string_scan_byte string_scan_splat(char Byte) { return _mm_set1_epi8(Byte); }
+
+fn_inline u32
+string_match_mask(const char* String, string_scan_byte Byte)
+{
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)String), Byte));
+}
+#endif
+
+const char* string_find_byte(const char* String, u64 Length, char Byte)
+{
+    u64 Index = 0;
+
+#if defined(STRING_SCAN_WIDTH)
+    string_scan_byte Target = string_scan_splat(Byte);
+    for (; Index + STRING_SCAN_WIDTH <= Length; Index += STRING_SCAN_WIDTH)
     {
-        if (*SourceA++ != *SourceB++) 
-            return false;
+        u32 Mask = string_match_mask(String + Index, Target);
+        if (Mask) return String + Index + __builtin_ctz(Mask);
     }
 
-    return true;
+    if (Index < Length && Length >= STRING_SCAN_WIDTH)
+    { // Reload the last block, shifting out the bytes already checked
+        u64 LastBlock = Length - STRING_SCAN_WIDTH;
+        u32 Mask = string_match_mask(String + LastBlock, Target) >> (Index - LastBlock);
+        return Mask ? String + Index + __builtin_ctz(Mask) : NULL;
+    }
+#endif
+
+    for (; Index < Length; ++Index)
+    {
+        if (String[Index] == Byte) return String + Index;
+    }
+    return NULL;
+}
+
+const char* string_find_either_byte(const char* String, u64 Length, char A, char B)
+{
+    u64 Index = 0;
+
+#if defined(STRING_SCAN_WIDTH)
+    string_scan_byte TargetA = string_scan_splat(A);
+    string_scan_byte TargetB = string_scan_splat(B);
+    for (; Index + STRING_SCAN_WIDTH <= Length; Index += STRING_SCAN_WIDTH)
+    {
+        u32 Mask = string_match_mask(String + Index, TargetA) | string_match_mask(String + Index, TargetB);
+        if (Mask) return String + Index + __builtin_ctz(Mask);
+    }
+
+    if (Index < Length && Length >= STRING_SCAN_WIDTH)
+    {
+        u64 LastBlock = Length - STRING_SCAN_WIDTH;
+        const char* Last = String + LastBlock;
+        u32 Mask = (string_match_mask(Last, TargetA) | string_match_mask(Last, TargetB)) >> (Index - LastBlock);
+        return Mask ? String + Index + __builtin_ctz(Mask) : NULL;
+    }
+#endif
+
+    for (; Index < Length; ++Index)
+    {
+        if (String[Index] == A || String[Index] == B) return String + Index;
+    }
+    return NULL;
+}
+
+const char* string_find(const char* String, u64 Length, const char* Needle, u64 NeedleLength)
+{
+    if (NeedleLength == 0)     return String;
+    if (NeedleLength > Length) return NULL;
+    if (NeedleLength == 1)     return string_find_byte(String, Length, Needle[0]);
+
+    u64 LastStart = Length - NeedleLength;
+    u64 Start     = 0;
+
+#if defined(STRING_SCAN_WIDTH)
+    // Bit i is set when start Start + i matches the needle's first and last bytes. The last
+    // candidate of a block reads up to String[Start + STRING_SCAN_WIDTH - 1 + NeedleLength - 1],
+    // which is in bounds as long as that candidate is.
+    string_scan_byte First = string_scan_splat(Needle[0]);
+    string_scan_byte Last  = string_scan_splat(Needle[NeedleLength - 1]);
+    for (; Start + STRING_SCAN_WIDTH <= LastStart + 1; Start += STRING_SCAN_WIDTH)
+    {
+        u32 Mask = string_match_mask(String + Start, First) & 
+                   string_match_mask(String + Start + NeedleLength - 1, Last);
+        while (Mask)
+        {
+            u64 Candidate = Start + __builtin_ctz(Mask);
+            if (memory_equal(String + Candidate + 1, Needle + 1, NeedleLength - 2))
+                return String + Candidate;
+            Mask &= Mask - 1;
+        }
+    }
+#endif
+
+    for (; Start <= LastStart; ++Start)
+    {
+        if (String[Start] == Needle[0] && String[Start + NeedleLength - 1] == Needle[NeedleLength - 1] &&
+            memory_equal(String + Start + 1, Needle + 1, NeedleLength - 2))
+            return String + Start;
+    }
+    return NULL;
 }
 
 // duplicate and ncopy allocate memory
@@ -235,24 +361,69 @@ u64 string_read_to_delim(char* Destination, char* Source, char Delimiter)
     return CharsRead;
 }
 
+// sscanf skipped leading whitespace, the str_view parsers don't
+fn_internal str_view
+string_number_view(char* Str)
+{
+    while (isspace((unsigned char)*Str)) Str++;
+    return str_view_from_cstr(Str);
+}
+
 bool string_to_f32(char* Str, f32* OutF32)
 {
     if (Str)
     {
-        *OutF32 = 0.0f;
-        s32 Result = sscanf(Str, "%f", OutF32);
-        return Result != -1;
+        u64 Consumed = 0;
+        return str_view_parse_f32(string_number_view(Str), OutF32, &Consumed) == parse_number_ok;
     }
     return false;
 }
 
+fn_internal parse_number_error parse_int_radix(str_view View, u64 Radix, u64* OutValue, u64* OutConsumed);
+
 bool string_to_int(char* Str, s32* OutS32)
 {
     if (Str)
     {
-        *OutS32 = 0.0f;
-        s32 Result = sscanf(Str, "%i", OutS32);
-        return Result != -1;
+        *OutS32 = 0;
+        str_view View = string_number_view(Str);
+
+        u64 Index = 0;
+        bool Negative = false;
+        if (View.Length && (View.Data[0] == '-' || View.Data[0] == '+'))
+        {
+            Negative = View.Data[0] == '-';
+            Index = 1;
+        }
+
+        // Like %i, 0x is hex and a leading 0 is octal
+        u64 Radix = 10;
+        if (Index + 1 < View.Length && View.Data[Index] == '0')
+        {
+            char Next = View.Data[Index + 1];
+            if ((Next == 'x' || Next == 'X') && Index + 2 < View.Length && isxdigit((unsigned char)View.Data[Index + 2]))
+            {
+                Radix  = 16;
+                Index += 2;
+            }
+            else if (Next >= '0' && Next <= '9')
+            { // The leading 0 is an octal digit too, so "08" stops after it like %i does
+                Radix = 8;
+            }
+        }
+
+        u64 Magnitude = 0;
+        u64 Consumed  = 0;
+        str_view Digits = str_view_skip(View, Index);
+        parse_number_error Error = (Radix == 10)
+            ? str_view_parse_u64(Digits, &Magnitude, &Consumed)
+            : parse_int_radix(Digits, Radix, &Magnitude, &Consumed);
+
+        if (Error != parse_number_ok || Digits.Data[0] == '+') return false; // No second sign
+        if (Magnitude > (u64)I32_MAX + (Negative ? 1 : 0))     return false;
+
+        *OutS32 = Negative ? (s32)(0 - Magnitude) : (s32)Magnitude;
+        return true;
     }
     return false;
 }
@@ -261,30 +432,1710 @@ bool string_uint(char* Str, u32* OutU32)
 {
     if (Str)
     {
-        *OutU32 = 0.0f;
-        s32 Result = sscanf(Str, "%u", OutU32);
-        return Result != -1;
+        *OutU32 = 0;
+        u64 Value    = 0;
+        u64 Consumed = 0;
+        if (str_view_parse_u64(string_number_view(Str), &Value, &Consumed) != parse_number_ok || Value > U32_MAX)
+            return false;
+
+        *OutU32 = (u32)Value;
+        return true;
     }
     return false;
 }
 
-void* chibi_memory_alloc(u64 Size) { return malloc(Size); }
-void  chibi_memory_free(void* Memory) { free(Memory); }
 
-void  
-chibi_memory_set(void* Memory, int Byte, u64 Size)
+//
+// String Views
+//
+
+str_view str_view_from_cstr(const char* String)
 {
-    u8* Iter = (u8*)Memory;
-    while (Size--) { *Iter++ = Byte; } 
+    return str_view_make(String, string_len(String));
 }
 
-void  
-chibi_memory_copy(void* Destination, void* Source, u64 CopySize)
+str_view str_view_slice(str_view View, u64 Start, u64 End)
 {
-    memcpy(Destination, Source, CopySize);
+    if (End   > View.Length) End   = View.Length;
+    if (Start > End)         Start = End;
+    return str_view_make(View.Data + Start, End - Start);
 }
 
-bool chibi_memory_cmp(void* Left, void* Right, u64 Size)
+str_view str_view_prefix(str_view View, u64 Count)
+{
+    return str_view_slice(View, 0, Count);
+}
+
+str_view str_view_suffix(str_view View, u64 Count)
+{
+    if (Count > View.Length) Count = View.Length;
+    return str_view_make(View.Data + View.Length - Count, Count);
+}
+
+str_view str_view_skip(str_view View, u64 Count)
+{
+    return str_view_slice(View, Count, View.Length);
+}
+
+bool str_view_equals(str_view Left, str_view Right)
+{
+    return Left.Length == Right.Length && mem_cmp(Left.Data, Right.Data, Left.Length);
+}
+
+bool str_view_starts_with(str_view View, str_view Prefix)
+{
+    return View.Length >= Prefix.Length && mem_cmp(View.Data, Prefix.Data, Prefix.Length);
+}
+
+bool str_view_ends_with(str_view View, str_view Suffix)
+{
+    return View.Length >= Suffix.Length && 
+        mem_cmp(View.Data + View.Length - Suffix.Length, Suffix.Data, Suffix.Length);
+}
+
+u64 str_view_find_char(str_view View, char Character)
+{
+    const char* Match = string_find_byte(View.Data, View.Length, Character);
+    return Match ? (u64)(Match - View.Data) : STR_VIEW_NOT_FOUND;
+}
+
+u64 str_view_find_last_char(str_view View, char Character)
+{
+    for (u64 Index = View.Length; Index > 0; --Index)
+    {
+        if (View.Data[Index - 1] == Character)
+            return Index - 1;
+    }
+    return STR_VIEW_NOT_FOUND;
+}
+
+u64 str_view_find(str_view View, str_view Needle)
+{
+    const char* Match = string_find(View.Data, View.Length, Needle.Data, Needle.Length);
+    return Match ? (u64)(Match - View.Data) : STR_VIEW_NOT_FOUND;
+}
+
+fn_inline bool str_is_space(char Character)
+{
+    return Character == ' ' || Character == '\t' || Character == '\r' || Character == '\n';
+}
+
+str_view str_view_trim_left(str_view View)
+{
+    u64 Start = 0;
+    while (Start < View.Length && str_is_space(View.Data[Start])) ++Start;
+    return str_view_make(View.Data + Start, View.Length - Start);
+}
+
+str_view str_view_trim_right(str_view View)
+{
+    u64 Length = View.Length;
+    while (Length > 0 && str_is_space(View.Data[Length - 1])) --Length;
+    return str_view_make(View.Data, Length);
+}
+
+str_view str_view_trim(str_view View)
+{
+    return str_view_trim_right(str_view_trim_left(View));
+}
+
+str_view str_view_chop(str_view* View, char Delimiter)
+{
+    u64 Index = str_view_find_char(*View, Delimiter);
+    if (Index == STR_VIEW_NOT_FOUND)
+    {
+        str_view Result = *View;
+        *View = str_view_make(View->Data + View->Length, 0);
+        return Result;
+    }
+
+    str_view Result = str_view_make(View->Data, Index);
+    *View = str_view_skip(*View, Index + 1);
+    return Result;
+}
+
+bool str_view_next_line(str_view* View, str_view* OutLine)
+{
+    if (View->Length == 0) return false;
+
+    str_view Line = str_view_chop(View, '\n');
+    if (Line.Length && Line.Data[Line.Length - 1] == '\r')
+        Line.Length -= 1;
+
+    *OutLine = Line;
+    return true;
+}
+
+str_split_iter str_view_split(str_view View, char Delimiter)
+{
+    str_split_iter Result = { .Remaining = View, .Delimiter = Delimiter, .Done = false };
+    return Result;
+}
+
+bool str_split_next(str_split_iter* Iter, str_view* OutToken)
+{
+    if (Iter->Done) return false;
+
+    u64 Index = str_view_find_char(Iter->Remaining, Iter->Delimiter);
+    if (Index == STR_VIEW_NOT_FOUND)
+    { // The last token is the one without a delimiter after it
+        *OutToken  = Iter->Remaining;
+        Iter->Done = true;
+        return true;
+    }
+
+    *OutToken       = str_view_prefix(Iter->Remaining, Index);
+    Iter->Remaining = str_view_skip(Iter->Remaining, Index + 1);
+    return true;
+}
+
+//
+// Number parsing
+//
+
+fn_inline bool parse_is_digit(char Character) { return (u8)(Character - '0') <= 9; }
+
+fn_inline bool
+parse_is_eight_digits(u64 Chunk)
+{ // Every byte is in 0x30-0x39: the high nibble is 3, and adding 6 doesn't carry in to it
+    return ((Chunk & 0xF0F0F0F0F0F0F0F0ull) | 
+           (((Chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+// Combines 8 digit values (0-9), most significant in the low byte, with three multiplies
+fn_inline u32
+parse_eight_digit_values(u64 Chunk)
+{
+    Chunk = (Chunk * 10) + (Chunk >> 8); // Every other byte holds a pair of digits
+    Chunk = (((Chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+             (((Chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    return (u32)Chunk;
+}
+
+// Converts 8 ascii digits, loaded little endian
+fn_inline u32
+parse_eight_digits(u64 Chunk)
+{
+    return parse_eight_digit_values(Chunk - 0x3030303030303030ull);
+}
+
+// Accumulates the digits starting at *Index in to *Value, wrapping on overflow. Advances *Index
+// past the digits.
+fn_internal void
+parse_digits(const char* Data, u64 Length, u64* Index, u64* Value)
+{
+    u64 i      = *Index;
+    u64 Result = *Value;
+
+    while (i + 8 <= Length)
+    {
+        u64 Chunk;
+        memcpy(&Chunk, Data + i, sizeof(Chunk));
+        if (!parse_is_eight_digits(Chunk)) break;
+
+        Result = Result * 100000000ull + parse_eight_digits(Chunk);
+        i += 8;
+    }
+
+    while (i < Length && parse_is_digit(Data[i]))
+    {
+        Result = Result * 10 + (u64)(Data[i] - '0');
+        i += 1;
+    }
+
+    *Index = i;
+    *Value = Result;
+}
+
+// Parses decimal digits from Index on. *OutEnd receives the index after the last digit.
+fn_internal parse_number_error
+parse_magnitude(str_view View, u64 Index, u64* OutValue, u64* OutEnd)
+{
+    u64 Start = Index;
+    while (Index < View.Length && View.Data[Index] == '0') Index++;
+
+    u64 SignificantStart = Index;
+    u64 Value = 0;
+    parse_digits(View.Data, View.Length, &Index, &Value);
+    if (Index == Start) return parse_number_invalid;
+
+    // Any 20 digit number starting with 2 or more is too big. One starting with 1 that
+    // overflowed wrapped at most once, which leaves it below 10^19.
+    u64 Significant = Index - SignificantStart;
+    if (Significant > 20 ||
+        (Significant == 20 && (View.Data[SignificantStart] > '1' || Value < 10000000000000000000ull)))
+        return parse_number_overflow;
+
+    *OutValue = Value;
+    *OutEnd   = Index;
+    return parse_number_ok;
+}
+
+parse_number_error str_view_parse_u64(str_view View, u64* OutValue, u64* OutConsumed)
+{
+    *OutValue    = 0;
+    *OutConsumed = 0;
+
+    u64 Index = (View.Length && View.Data[0] == '+') ? 1 : 0;
+    return parse_magnitude(View, Index, OutValue, OutConsumed);
+}
+
+parse_number_error str_view_parse_s64(str_view View, s64* OutValue, u64* OutConsumed)
+{
+    *OutValue    = 0;
+    *OutConsumed = 0;
+
+    u64  Index    = 0;
+    bool Negative = false;
+    if (View.Length && (View.Data[0] == '-' || View.Data[0] == '+'))
+    {
+        Negative = View.Data[0] == '-';
+        Index    = 1;
+    }
+
+    u64 Magnitude = 0;
+    u64 End       = 0;
+    parse_number_error Error = parse_magnitude(View, Index, &Magnitude, &End);
+    if (Error != parse_number_ok) return Error;
+
+    // The negative range has one more value than the positive one
+    if (Magnitude > (u64)I64_MAX + (Negative ? 1 : 0)) return parse_number_overflow;
+
+    *OutValue    = Negative ? (s64)(0 - Magnitude) : (s64)Magnitude;
+    *OutConsumed = End;
+    return parse_number_ok;
+}
+
+// Scalar parser for the hex and octal forms string_to_int accepts
+fn_internal parse_number_error
+parse_int_radix(str_view View, u64 Radix, u64* OutValue, u64* OutConsumed)
+{
+    *OutValue    = 0;
+    *OutConsumed = 0;
+
+    u64 Value = 0;
+    u64 Index = 0;
+    for (; Index < View.Length; ++Index)
+    {
+        char Character = View.Data[Index];
+        u64 Digit = 0;
+        if      (Character >= '0' && Character <= '9') Digit = Character - '0';
+        else if (Character >= 'a' && Character <= 'f') Digit = Character - 'a' + 10;
+        else if (Character >= 'A' && Character <= 'F') Digit = Character - 'A' + 10;
+        else break;
+        if (Digit >= Radix) break;
+
+        if (Value > (U64_MAX - Digit) / Radix) return parse_number_overflow;
+        Value = Value * Radix + Digit;
+    }
+
+    if (Index == 0) return parse_number_invalid;
+
+    *OutValue    = Value;
+    *OutConsumed = Index;
+    return parse_number_ok;
+}
+
+typedef struct
+{
+    u64  Mantissa;
+    s64  Exponent; // Power of 10 the mantissa is scaled by
+    u64  Length;   // Bytes that make up the number
+    bool Negative;
+    bool Exact;    // The mantissa holds every significant digit
+} parsed_decimal;
+
+// Splits a decimal float in to its mantissa and exponent. Returns false if there are no digits.
+fn_internal bool
+parse_decimal(str_view View, parsed_decimal* Out)
+{
+    const char* Data   = View.Data;
+    u64         Length = View.Length;
+    u64         i      = 0;
+
+    mem_zero(Out, sizeof(parsed_decimal));
+    if (i < Length && (Data[i] == '-' || Data[i] == '+'))
+    {
+        Out->Negative = Data[i] == '-';
+        i += 1;
+    }
+
+    // Leading zeros aren't significant
+    u64 DigitsStart = i;
+    while (i < Length && Data[i] == '0') i++;
+
+    u64 Mantissa         = 0;
+    u64 SignificantStart = i;
+    parse_digits(Data, Length, &i, &Mantissa);
+    u64 Significant = i - SignificantStart;
+    bool AnyDigits  = i > DigitsStart;
+
+    s64 Exponent = 0;
+    if (i < Length && Data[i] == '.')
+    {
+        i += 1;
+        u64 FractionStart = i;
+        if (Significant == 0)
+        { // Zeros right after the point only move the exponent
+            while (i < Length && Data[i] == '0') i++;
+        }
+
+        SignificantStart = i;
+        parse_digits(Data, Length, &i, &Mantissa);
+        Significant += i - SignificantStart;
+        Exponent    -= (s64)(i - FractionStart);
+        AnyDigits   |= i > FractionStart;
+    }
+
+    if (!AnyDigits) return false;
+
+    // The exponent is only part of the number if it has digits
+    if (i < Length && (Data[i] == 'e' || Data[i] == 'E'))
+    {
+        u64  j                = i + 1;
+        bool NegativeExponent = false;
+        if (j < Length && (Data[j] == '-' || Data[j] == '+'))
+        {
+            NegativeExponent = Data[j] == '-';
+            j += 1;
+        }
+
+        if (j < Length && parse_is_digit(Data[j]))
+        {
+            s64 Value = 0;
+            for (; j < Length && parse_is_digit(Data[j]); ++j)
+            {
+                if (Value < 100000) Value = Value * 10 + (Data[j] - '0'); // Far past the range of a double
+            }
+
+            Exponent += NegativeExponent ? -Value : Value;
+            i = j;
+        }
+    }
+
+    Out->Mantissa = Mantissa;
+    Out->Exponent = Exponent;
+    Out->Length   = i;
+    Out->Exact    = Significant <= 19; // 19 digits always fit in a u64
+    return true;
+}
+
+// strtod/strtof on a null terminated copy of the first Length bytes of View
+fn_internal parse_number_error
+parse_float_fallback(str_view View, u64 Length, bool Single, f64* OutValue, u64* OutConsumed)
+{
+    arena_marker Scratch = scratch_begin(NULL, 0);
+    char* Copy = arena_push_array(Scratch.Arena, char, Length + 1);
+    mem_copy(Copy, View.Data, Length);
+    Copy[Length] = 0;
+
+    char* End = NULL;
+    errno = 0;
+    f64 Value = Single ? (f64)strtof(Copy, &End) : strtod(Copy, &End);
+    bool OutOfRange = errno == ERANGE;
+    u64  Consumed   = (u64)(End - Copy);
+    scratch_end(Scratch);
+
+    if (Consumed == 0) return parse_number_invalid;
+    // Underflow rounds to zero or a denormal, only overflow is an error
+    if (OutOfRange && (Value > F64_MAX || Value < F64_MIN)) return parse_number_overflow;
+
+    *OutValue    = Value;
+    *OutConsumed = Consumed;
+    return parse_number_ok;
+}
+
+// Handles views that don't start with digits: inf, infinity and nan go to strtod
+fn_internal parse_number_error
+parse_float_special(str_view View, bool Single, f64* OutValue, u64* OutConsumed)
+{
+    u64 Index = (View.Length && (View.Data[0] == '-' || View.Data[0] == '+')) ? 1 : 0;
+    if (Index >= View.Length) return parse_number_invalid;
+
+    char First = View.Data[Index] | 0x20; // Lower case
+    if (First != 'i' && First != 'n') return parse_number_invalid;
+
+    u64 Length = View.Length < 64 ? View.Length : 64;
+    return parse_float_fallback(View, Length, Single, OutValue, OutConsumed);
+}
+
+var_global const f64 cPowersOf10F64[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+var_global const f32 cPowersOf10F32[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+parse_number_error str_view_parse_f64(str_view View, f64* OutValue, u64* OutConsumed)
+{
+    *OutValue    = 0;
+    *OutConsumed = 0;
+
+    parsed_decimal Decimal;
+    if (!parse_decimal(View, &Decimal))
+        return parse_float_special(View, false, OutValue, OutConsumed);
+
+    // Clinger's fast path: the mantissa and the power of 10 are both exact doubles, so a single
+    // multiply or divide rounds correctly
+    if (Decimal.Exact && Decimal.Mantissa <= (1ull << 53) && Decimal.Exponent >= -22 && Decimal.Exponent <= 22)
+    {
+        f64 Value = (f64)Decimal.Mantissa;
+        if (Decimal.Exponent < 0) Value /= cPowersOf10F64[-Decimal.Exponent];
+        else                      Value *= cPowersOf10F64[Decimal.Exponent];
+
+        *OutValue    = Decimal.Negative ? -Value : Value;
+        *OutConsumed = Decimal.Length;
+        return parse_number_ok;
+    }
+
+    return parse_float_fallback(View, Decimal.Length, false, OutValue, OutConsumed);
+}
+
+parse_number_error str_view_parse_f32(str_view View, f32* OutValue, u64* OutConsumed)
+{
+    *OutValue    = 0;
+    *OutConsumed = 0;
+
+    f64 Value = 0;
+    parse_number_error Error = parse_number_ok;
+
+    parsed_decimal Decimal;
+    if (!parse_decimal(View, &Decimal))
+    {
+        Error = parse_float_special(View, true, &Value, OutConsumed);
+    }
+    else if (Decimal.Exact && Decimal.Mantissa <= (1ull << 24) && Decimal.Exponent >= -10 && Decimal.Exponent <= 10)
+    { // Same fast path in single precision
+        f32 Single = (f32)Decimal.Mantissa;
+        if (Decimal.Exponent < 0) Single /= cPowersOf10F32[-Decimal.Exponent];
+        else                      Single *= cPowersOf10F32[Decimal.Exponent];
+
+        *OutValue    = Decimal.Negative ? -Single : Single;
+        *OutConsumed = Decimal.Length;
+        return parse_number_ok;
+    }
+    else
+    {
+        Error = parse_float_fallback(View, Decimal.Length, true, &Value, OutConsumed);
+    }
+
+    if (Error == parse_number_ok) *OutValue = (f32)Value; // strtof's result, exact in a double
+    return Error;
+}
+
+//
+// Bulk integer extraction
+//
+
+#define INTEGER_SCAN_WIDTH 32
+
+var_global const u64 cPowersOf10U64[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+};
+
+// Converts a run of 1 to 16 digits whose length is already known, without looking at the bytes
+// one by one. Reads 16 bytes from Data.
+fn_inline u64
+integer_parse_run(const char* Data, u64 RunLength)
+{
+    u64 Lo, Hi;
+    memcpy(&Lo, Data,     sizeof(Lo));
+    memcpy(&Hi, Data + 8, sizeof(Hi));
+
+    // Shifting left drops the bytes past the run and leaves zeros in front of the digits.
+    // Bytes below '0' borrow from the byte above them, those are shifted out too.
+    u64 LoLength = RunLength < 8 ? RunLength : 8;
+    u64 HiLength = RunLength - LoLength;
+    u64 LoValue  = parse_eight_digit_values((Lo - 0x3030303030303030ull) << (8 * (8 - LoLength)));
+    u64 HiValue  = parse_eight_digit_values(((Hi - 0x3030303030303030ull) << 1) << (8 * (8 - HiLength) - 1)); // 64 bit shifts aren't defined
+    return LoValue * cPowersOf10U64[HiLength] + HiValue;
+}
+
+// Bit i of *OutDigits is set if Data[i] is a digit, same for *OutNewlines and '\n'. Count is at
+// most INTEGER_SCAN_WIDTH.
+fn_inline void
+integer_scan_masks(const char* Data, u64 Count, u32* OutDigits, u32* OutNewlines)
 {
-    return memcmp(Left, Right, Size) == 0;
+#if defined(__AVX2__)
+    if (Count == INTEGER_SCAN_WIDTH)
+    {
+        __m256i Bytes   = _mm256_loadu_si256((const __m256i*)Data);
+        __m256i Offset  = _mm256_sub_epi8(Bytes, _mm256_set1_epi8('0'));
+        __m256i Digits  = _mm256_cmpeq_epi8(_mm256_min_epu8(Offset, _mm256_set1_epi8(9)), Offset); // (c - '0') <= 9
+        __m256i Newline = _mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8('\n'));
+        *OutDigits   = (u32)_mm256_movemask_epi8(Digits);
+        *OutNewlines = (u32)_mm256_movemask_epi8(Newline);
+        return;
+    }
+#elif defined(__SSE2__)
+    if (Count == INTEGER_SCAN_WIDTH)
+    {
+        u32 Digits   = 0;
+        u32 Newlines = 0;
+        ForRange(u32, Half, 2)
+        {
+            __m128i Bytes   = _mm_loadu_si128((const __m128i*)(Data + Half * 16));
+            __m128i Offset  = _mm_sub_epi8(Bytes, _mm_set1_epi8('0'));
+            __m128i Digit   = _mm_cmpeq_epi8(_mm_min_epu8(Offset, _mm_set1_epi8(9)), Offset);
+            __m128i Newline = _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\n'));
+            Digits   |= (u32)_mm_movemask_epi8(Digit)   << (Half * 16);
+            Newlines |= (u32)_mm_movemask_epi8(Newline) << (Half * 16);
+        }
+        *OutDigits   = Digits;
+        *OutNewlines = Newlines;
+        return;
+    }
+#endif
+
+    u32 Digits   = 0;
+    u32 Newlines = 0;
+    ForRange(u64, i, Count)
+    {
+        Digits   |= (u32)parse_is_digit(Data[i]) << i;
+        Newlines |= (u32)(Data[i] == '\n')      << i;
+    }
+    *OutDigits   = Digits;
+    *OutNewlines = Newlines;
+}
+
+// Number of digits at the start of a 16 byte window, 16 if every byte is a digit
+fn_inline u64
+integer_run_length(const char* Data)
+{
+#if defined(__SSE2__)
+    __m128i Bytes  = _mm_loadu_si128((const __m128i*)Data);
+    __m128i Offset = _mm_sub_epi8(Bytes, _mm_set1_epi8('0'));
+    __m128i Digits = _mm_cmpeq_epi8(_mm_min_epu8(Offset, _mm_set1_epi8(9)), Offset);
+    return __builtin_ctz(~(u32)_mm_movemask_epi8(Digits));
+#else
+    u64 Run = 0;
+    while (Run < 16 && parse_is_digit(Data[Run])) Run++;
+    return Run;
+#endif
+}
+
+// Mask of the bits at or after Offset in a chunk, without a branch on whether the offset is
+// past the chunk
+fn_inline u32
+integer_bits_from(u64 Offset)
+{
+    if (Offset > 63) Offset = 63;
+    return (u32)(~0ull << Offset);
+}
+
+integer_extract_result str_view_extract_integers(str_view Text, s64* OutValues, u64 ValueCapacity,
+                                                 u64* OutLineOffsets, u64 LineOffsetCapacity)
+{
+    const char* Data   = Text.Data;
+    u64         Length = Text.Length;
+
+    integer_extract_result Result = {0};
+    Result.LineCount = 1;
+    if (OutLineOffsets && LineOffsetCapacity > 0) OutLineOffsets[0] = 0;
+
+    u64 Resume = 0; // End of the last number, which can reach in to later chunks
+    for (u64 Pos = 0; Pos < Length; Pos += INTEGER_SCAN_WIDTH)
+    {
+        u64 Count = Length - Pos;
+        if (Count > INTEGER_SCAN_WIDTH) Count = INTEGER_SCAN_WIDTH;
+
+        u32 Digits, Newlines;
+        integer_scan_masks(Data + Pos, Count, &Digits, &Newlines);
+
+        // Digits after the first in a run are never starts, so each start is one number. Only a
+        // number that reaches in from the previous chunk needs masking.
+        u32 Starts = Digits & ~(Digits << 1);
+        if (Resume > Pos)
+            Starts &= integer_bits_from(Resume - Pos);
+
+        // A line begins after however many numbers start before its newline. Counting them
+        // keeps newlines out of the number loop, where they would be a branch per number.
+        if (OutLineOffsets)
+        {
+            while (Newlines)
+            {
+                u32 Bit = __builtin_ctz(Newlines);
+                Newlines &= Newlines - 1;
+                if (Pos + Bit + 1 == Length) break;
+
+                if (Result.LineCount < LineOffsetCapacity)
+                    OutLineOffsets[Result.LineCount] = Result.ValueCount + __builtin_popcount(Starts & ((1u << Bit) - 1));
+                Result.LineCount += 1;
+            }
+        }
+
+        while (Starts)
+        {
+            u64 At = Pos + __builtin_ctz(Starts);
+            Starts &= Starts - 1;
+
+            // Random signs mispredict badly, so no short circuits
+            u64 Negative = 0;
+            if (At > 1) Negative = (Data[At - 1] == '-') & !parse_is_digit(Data[At - 2]);
+            else        Negative = (At == 1) & (Data[0] == '-');
+
+            u64 Run   = (At + 16 <= Length) ? integer_run_length(Data + At) : 16;
+            u64 End   = At + Run;
+            u64 Value = 0;
+            if (Run < 16)
+            {
+                Value = integer_parse_run(Data + At, Run);
+            }
+            else
+            { // Long, or too close to the end of the text to over-read
+                End = At;
+                parse_digits(Data, Length, &End, &Value);
+            }
+
+            if (Result.ValueCount < ValueCapacity) OutValues[Result.ValueCount] = (s64)((Value ^ (0 - Negative)) + Negative);
+            Result.ValueCount += 1;
+            Resume = End;
+        }
+    }
+
+    if (OutLineOffsets && Result.LineCount < LineOffsetCapacity) OutLineOffsets[Result.LineCount] = Result.ValueCount;
+    return Result;
+}
+
+integer_extract_result str_view_count_integers(str_view Text)
+{
+    const char* Data   = Text.Data;
+    u64         Length = Text.Length;
+
+    integer_extract_result Result = {0};
+    Result.LineCount = 1;
+
+    // Every run of digits is one value, a run carried over from the previous chunk isn't a start
+    u32 Carry = 0;
+    for (u64 Pos = 0; Pos < Length; Pos += INTEGER_SCAN_WIDTH)
+    {
+        u64 Count = Length - Pos;
+        if (Count > INTEGER_SCAN_WIDTH) Count = INTEGER_SCAN_WIDTH;
+
+        u32 Digits, Newlines;
+        integer_scan_masks(Data + Pos, Count, &Digits, &Newlines);
+
+        Result.ValueCount += __builtin_popcount(Digits & ~((Digits << 1) | Carry));
+        Result.LineCount  += __builtin_popcount(Newlines);
+        Carry = Digits >> 31;
+    }
+
+    // Same as str_view_extract_integers, a trailing newline doesn't start a new line
+    if (Length > 0 && Data[Length - 1] == '\n') Result.LineCount -= 1;
+    return Result;
+}
+
+string_matcher string_matcher_build(const char** Words, u32 WordCount, bool Reverse)
+{
+    string_matcher Result = { .Reverse = Reverse };
+
+    u32 MaxStates = 1;
+    ForRange(u32, i, WordCount)
+        MaxStates += (u32)string_len(Words[i]);
+    cassert(MaxStates <= U16_MAX);
+
+    Result.Transitions = mem_alloc(u16, MaxStates * 256);
+    Result.Matches     = mem_alloc(s32, MaxStates);
+    Result.WordLengths = mem_alloc(u32, WordCount);
+    mem_zero(Result.Transitions, sizeof(u16) * MaxStates * 256);
+
+    // Build the trie. While building, a transition to 0 means "no child", the root can't be
+    // the child of another state.
+    Result.StateCount = 1;
+    Result.Matches[0] = -1;
+    ForRange(u32, i, WordCount)
+    {
+        u32 Length = (u32)string_len(Words[i]);
+        Result.WordLengths[i] = Length;
+
+        u32 State = 0;
+        ForRange(u32, j, Length)
+        {
+            u8 Char = (u8)(Reverse ? Words[i][Length - 1 - j] : Words[i][j]);
+            u16* Next = &Result.Transitions[State * 256 + Char];
+            if (*Next == 0)
+            {
+                Result.Matches[Result.StateCount] = -1;
+                *Next = (u16)Result.StateCount++;
+            }
+            State = *Next;
+        }
+
+        if (Result.Matches[State] == -1)
+            Result.Matches[State] = (s32)i;
+    }
+
+    // Breadth first pass to compute failure links. Missing transitions are replaced with
+    // the transition of the failure state, which has already been resolved since it is
+    // shallower in the trie. A state inherits the match of its failure state.
+    u32* Failure = mem_alloc(u32, Result.StateCount);
+    u32* Queue   = mem_alloc(u32, Result.StateCount);
+    u32 QueueHead = 0;
+    u32 QueueTail = 0;
+
+    Failure[0] = 0;
+    Queue[QueueTail++] = 0;
+    while (QueueHead < QueueTail)
+    {
+        u32 State = Queue[QueueHead++];
+        ForRange(u32, Char, 256)
+        {
+            u16* Next = &Result.Transitions[State * 256 + Char];
+            if (*Next != 0)
+            {
+                u32 Child = *Next;
+                Failure[Child] = (State == 0) ? 0 : Result.Transitions[Failure[State] * 256 + Char];
+                if (Result.Matches[Child] == -1)
+                    Result.Matches[Child] = Result.Matches[Failure[Child]];
+                Queue[QueueTail++] = Child;
+            }
+            else if (State != 0)
+            {
+                *Next = Result.Transitions[Failure[State] * 256 + Char];
+            }
+        }
+    }
+
+    mem_free(Failure);
+    mem_free(Queue);
+
+    return Result;
+}
+
+void string_matcher_free(string_matcher* Matcher)
+{
+    mem_free(Matcher->Transitions);
+    mem_free(Matcher->Matches);
+    mem_free(Matcher->WordLengths);
+    mem_zero(Matcher, sizeof(string_matcher));
+}
+
+s32 string_matcher_find_first(string_matcher* Matcher, const char* Stream, u64 Length, u64* OutPosition)
+{
+    cassert(!Matcher->Reverse);
+
+    u32 State = 0;
+    ForRange(u64, i, Length)
+    {
+        State = Matcher->Transitions[State * 256 + (u8)Stream[i]];
+        s32 Match = Matcher->Matches[State];
+        if (Match >= 0)
+        {
+            *OutPosition = i + 1 - Matcher->WordLengths[Match];
+            return Match;
+        }
+    }
+
+    return -1;
+}
+
+s32 string_matcher_find_last(string_matcher* Matcher, const char* Stream, u64 Length, u64* OutPosition)
+{
+    cassert(Matcher->Reverse);
+
+    u32 State = 0;
+    ForRangeReverse(s64, i, (s64)Length)
+    {
+        State = Matcher->Transitions[State * 256 + (u8)Stream[i]];
+        s32 Match = Matcher->Matches[State];
+        if (Match >= 0)
+        {
+            *OutPosition = (u64)i;
+            return Match;
+        }
+    }
+
+    return -1;
+}
+
+// Address range of every arena that has been bound to a thread, so mem_free can tell arena
+// memory apart from heap memory no matter which thread frees it, or what that thread has
+// bound. A slot is claimed by setting Base and cleared again by arena_release.
+#define BOUND_ARENA_SLOTS 64
+
+typedef struct
+{
+    void* volatile Base;
+    void* volatile End; // NULL while the slot is being claimed or cleared
+} bound_arena_range;
+
+var_global bound_arena_range gBoundArenas[BOUND_ARENA_SLOTS];
+
+fn_internal bool
+chibi_memory_is_arena_pointer(void* Memory)
+{
+    ForRange(u32, i, BOUND_ARENA_SLOTS)
+    {
+        u8* Base = (u8*)atomic_load_explicit_ptr(&gBoundArenas[i].Base, atomic_order_acquire);
+        u8* End  = (u8*)atomic_load_explicit_ptr(&gBoundArenas[i].End,  atomic_order_acquire);
+        if (End && (u8*)Memory >= Base && (u8*)Memory < End)
+            return true;
+    }
+    return false;
+}
+
+fn_internal void
+chibi_memory_register_arena(memory_arena* Arena)
+{
+    ForRange(u32, i, BOUND_ARENA_SLOTS)
+    {
+        if (atomic_load_explicit_ptr(&gBoundArenas[i].Base, atomic_order_acquire) == Arena->Base)
+            return; // Already bound by another thread
+    }
+
+    ForRange(u32, i, BOUND_ARENA_SLOTS)
+    {
+        void* Expected = NULL;
+        if (atomic_compare_exchange_ptr(&gBoundArenas[i].Base, &Expected, Arena->Base))
+        {
+            atomic_store_explicit_ptr(&gBoundArenas[i].End, Arena->Base + Arena->ReserveSize, atomic_order_release);
+            return;
+        }
+    }
+
+    cassert(false && "Too many arenas have been bound, raise BOUND_ARENA_SLOTS.");
+}
+
+fn_internal void
+chibi_memory_unregister_arena(memory_arena* Arena)
+{
+    ForRange(u32, i, BOUND_ARENA_SLOTS)
+    {
+        if (atomic_load_explicit_ptr(&gBoundArenas[i].Base, atomic_order_acquire) == Arena->Base)
+        {
+            atomic_store_explicit_ptr(&gBoundArenas[i].End,  NULL, atomic_order_release);
+            atomic_store_explicit_ptr(&gBoundArenas[i].Base, NULL, atomic_order_release);
+            return;
+        }
+    }
+}
+
+memory_arena arena_init(u64 ReserveSize)
+{
+    memory_arena Result = {0};
+    Result.Base = platform_virtual_reserve_memory(forward_align(ReserveSize, ARENA_COMMIT_SIZE));
+
+    // A failed arena is left empty, every push returns NULL
+    if (Result.Base)
+        Result.ReserveSize = forward_align(ReserveSize, ARENA_COMMIT_SIZE);
+    return Result;
+}
+
+void arena_release(memory_arena* Arena)
+{
+    if (Arena->Base)
+    {
+        chibi_memory_unregister_arena(Arena);
+        platform_virtual_free(Arena->Base, Arena->ReserveSize);
+    }
+    mem_zero(Arena, sizeof(memory_arena));
+}
+
+void* arena_push(memory_arena* Arena, u64 Size, u64 Alignment)
+{
+    u64 Start = forward_align(Arena->Pos, Alignment);
+    u64 End   = Start + Size;
+    if (End > Arena->ReserveSize)
+        return NULL;
+
+    if (End > Arena->CommitSize)
+    {
+        u64 NewCommitSize = forward_align(End, ARENA_COMMIT_SIZE);
+        if (NewCommitSize > Arena->ReserveSize) NewCommitSize = Arena->ReserveSize;
+
+        platform_virtual_map_to_physical(Arena->Base, Arena->CommitSize, NewCommitSize - Arena->CommitSize);
+        Arena->CommitSize = NewCommitSize;
+    }
+
+    Arena->Pos = End;
+    return Arena->Base + Start;
+}
+
+void* arena_push_zero(memory_arena* Arena, u64 Size, u64 Alignment)
+{
+    void* Result = arena_push(Arena, Size, Alignment);
+    if (Result) mem_zero(Result, Size);
+    return Result;
+}
+
+arena_marker arena_get_marker(memory_arena* Arena)
+{
+    arena_marker Result = { .Arena = Arena, .Pos = Arena->Pos };
+    return Result;
+}
+
+void arena_pop_to_marker(arena_marker Marker)
+{
+    cassert(Marker.Pos <= Marker.Arena->Pos);
+    Marker.Arena->Pos = Marker.Pos;
+}
+
+void arena_reset(memory_arena* Arena)
+{
+    Arena->Pos = 0;
+}
+
+var_thread_local memory_arena tScratchArenas[SCRATCH_ARENA_COUNT];
+
+arena_marker scratch_begin(memory_arena** Conflicts, u32 ConflictCount)
+{
+    ForRange(u32, i, SCRATCH_ARENA_COUNT)
+    {
+        memory_arena* Arena = &tScratchArenas[i];
+
+        bool IsConflict = false;
+        ForRange(u32, j, ConflictCount)
+        {
+            if (Conflicts[j] == Arena) { IsConflict = true; break; }
+        }
+        if (IsConflict) continue;
+
+        // Reserved the first time the thread asks for it
+        if (!Arena->Base)
+            *Arena = arena_init(SCRATCH_ARENA_RESERVE_SIZE);
+
+        return arena_get_marker(Arena);
+    }
+
+    cassert(false && "Every scratch arena conflicts.");
+    return (arena_marker){0};
+}
+
+void scratch_end(arena_marker Scratch)
+{
+    arena_pop_to_marker(Scratch);
+}
+
+var_thread_local memory_arena* tBoundArena = NULL;
+
+memory_arena* chibi_memory_bind_arena(memory_arena* Arena)
+{
+    if (Arena && Arena->Base)
+        chibi_memory_register_arena(Arena);
+
+    memory_arena* Previous = tBoundArena;
+    tBoundArena = Arena;
+    return Previous;
+}
+
+void* chibi_memory_alloc(u64 Size)
+{
+    if (!tBoundArena) return malloc(Size);
+
+    void* Result = arena_push(tBoundArena, Size, ARENA_DEFAULT_ALIGNMENT);
+    if (!Result)
+    {
+        log_error("Memory arena is out of reserved space: requested %lu bytes, %lu of %lu in use.",
+                Size, tBoundArena->Pos, tBoundArena->ReserveSize);
+    }
+    return Result;
+}
+
+void chibi_memory_free(void* Memory)
+{
+    if (!Memory) return;
+
+    // Released with the arena. Checked against every bound arena, not just this thread's,
+    // since the memory may have been allocated on another thread.
+    if (chibi_memory_is_arena_pointer(Memory))
+        return;
+
+    free(Memory);
+}
+
+void  
+chibi_memory_set(void* Memory, int Byte, u64 Size)
+{
+    memory_set(Memory, (u8)Byte, Size);
+}
+
+void  
+chibi_memory_copy(void* Destination, void* Source, u64 CopySize)
+{
+    memory_copy(Destination, Source, CopySize);
+}
+
+void  
+chibi_memory_move(void* Destination, void* Source, u64 MoveSize)
+{
+    memmove(Destination, Source, MoveSize);
+}
+
+bool chibi_memory_cmp(void* Left, void* Right, u64 Size)
+{
+    return memory_equal(Left, Right, Size);
+}
+
+//
+// Hashing
+//
+
+#define HASH_PRIME32   0x9E3779B1u
+#define HASH_PRIME64_1 0x9E3779B185EBCA87ull
+#define HASH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+
+// Stripe n of a block uses words [n, n + 8), the scramble and the last stripe use [16, 24)
+var_global const u64 cHashSecret[24] = {
+    0x2cb0f69f4abea221ull, 0x9417034723148989ull, 0xdd555950609dfe03ull, 0xdbafb150deb12800ull,
+    0x7e789b2e6c442cb6ull, 0xf41e5636c7e4f8c4ull, 0x0959d150f8fba7e4ull, 0xa97316f13cdb9eeaull,
+    0x74cd8258f9520068ull, 0x55c74a62e116868bull, 0xd2f4c799a2023cbdull, 0xdf98cb79a37b51b9ull,
+    0x396f5885524f3905ull, 0xaf1d56386ca3b276ull, 0xa9ffbe6b5104e85aull, 0x6bd0c51b9fd533b3ull,
+    0x980ce91c50ab4b56ull, 0x28ac395780fe62c5ull, 0x768912e3a6bcedc7ull, 0x50b3e8c9332c7c88ull,
+    0xce3bbfe520bd47daull, 0xcba6c8e8e0bb7c4full, 0xbf194db8434a346dull, 0x7d8f2a7b60416d7full,
+};
+
+#define HASH_FINAL_SECRET (cHashSecret + 16)
+
+fn_inline u64 hash_read64(const u8* Data) { u64 Value; memcpy(&Value, Data, sizeof(Value)); return Value; }
+fn_inline u32 hash_read32(const u8* Data) { u32 Value; memcpy(&Value, Data, sizeof(Value)); return Value; }
+
+// 64x64 -> 128 bit multiply, folded back down to 64 bits
+fn_inline u64 hash_mum(u64 A, u64 B)
+{
+    unsigned __int128 Product = (unsigned __int128)A * B;
+    return (u64)Product ^ (u64)(Product >> 64);
+}
+
+fn_inline u64 hash_avalanche(u64 Hash)
+{
+    Hash ^= Hash >> 37;
+    Hash *= 0x165667919E3779F9ull;
+    Hash ^= Hash >> 32;
+    return Hash;
+}
+
+fn_inline u64 hash_mix16(const u8* Data, const u64* Secret)
+{
+    return hash_mum(hash_read64(Data) ^ Secret[0], hash_read64(Data + 8) ^ Secret[1]);
+}
+
+fn_internal u64
+hash_short(const u8* Data, u64 Length)
+{
+    const u64* Secret = cHashSecret;
+
+    if (Length <= 16)
+    {
+        u64 Lo = 0;
+        u64 Hi = 0;
+        if (Length >= 8)
+        {
+            Lo = hash_read64(Data);
+            Hi = hash_read64(Data + Length - 8);
+        }
+        else if (Length >= 4)
+        {
+            Lo = hash_read32(Data);
+            Hi = hash_read32(Data + Length - 4);
+        }
+        else if (Length > 0)
+        {
+            Lo = ((u64)Data[0] << 16) | ((u64)Data[Length >> 1] << 8) | Data[Length - 1];
+        }
+
+        return hash_avalanche(hash_mum(Lo ^ Secret[0], Hi ^ Secret[1]) + Length * HASH_PRIME64_1);
+    }
+
+    // 16 byte chunks walking in from both ends, they overlap in the middle
+    u64 Acc   = Length * HASH_PRIME64_1;
+    u64 Pairs = (Length + 31) / 32;
+    ForRange(u64, i, Pairs)
+    {
+        Acc += hash_mix16(Data + 16 * i,                Secret + 4 * i);
+        Acc += hash_mix16(Data + Length - 16 * (i + 1), Secret + 4 * i + 2);
+    }
+
+    return hash_avalanche(Acc);
+}
+
+fn_internal void
+hash_acc_init(u64* Acc)
+{
+    Acc[0] = HASH_PRIME32;   Acc[1] = HASH_PRIME64_1; Acc[2] = HASH_PRIME64_2; Acc[3] = cHashSecret[3];
+    Acc[4] = cHashSecret[4]; Acc[5] = cHashSecret[5]; Acc[6] = cHashSecret[6]; Acc[7] = HASH_PRIME32 ^ 1;
+}
+
+// Each lane adds its neighbour's data, and the product of the two halves of its keyed data
+fn_inline void
+hash_accumulate_scalar(u64* Acc, const u8* Stripe, const u64* Secret)
+{
+    ForRange(u32, i, 8)
+    {
+        u64 Data = hash_read64(Stripe + 8 * i);
+        u64 Key  = Data ^ Secret[i];
+        Acc[i ^ 1] += Data;
+        Acc[i]     += (Key & 0xFFFFFFFF) * (Key >> 32);
+    }
+}
+
+fn_inline void
+hash_scramble_scalar(u64* Acc, const u64* Secret)
+{
+    ForRange(u32, i, 8)
+    {
+        u64 Value = Acc[i];
+        Value ^= Value >> 47;
+        Value ^= Secret[i];
+        Acc[i] = Value * HASH_PRIME32;
+    }
+}
+
+fn_internal void
+hash_consume_stripes_scalar(u64* Acc, u32* StripesInBlock, const u8* Data, u64 StripeCount)
+{
+    u32 InBlock = *StripesInBlock;
+    ForRange(u64, Stripe, StripeCount)
+    {
+        hash_accumulate_scalar(Acc, Data + Stripe * HASH_STRIPE_SIZE, cHashSecret + InBlock);
+        if (++InBlock == HASH_STRIPES_PER_BLOCK)
+        {
+            hash_scramble_scalar(Acc, HASH_FINAL_SECRET);
+            InBlock = 0;
+        }
+    }
+    *StripesInBlock = InBlock;
+}
+
+#if defined(__AVX2__)
+fn_inline __m256i
+hash_accumulate_avx2(__m256i Acc, const u8* Data, const u64* Secret)
+{
+    __m256i Value   = _mm256_loadu_si256((const __m256i*)Data);
+    __m256i Key     = _mm256_xor_si256(Value, _mm256_loadu_si256((const __m256i*)Secret));
+    __m256i Product = _mm256_mul_epu32(Key, _mm256_srli_epi64(Key, 32));
+    __m256i Swapped = _mm256_shuffle_epi32(Value, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm256_add_epi64(Acc, _mm256_add_epi64(Product, Swapped));
+}
+
+fn_inline __m256i
+hash_scramble_avx2(__m256i Acc, const u64* Secret)
+{
+    Acc = _mm256_xor_si256(Acc, _mm256_srli_epi64(Acc, 47));
+    Acc = _mm256_xor_si256(Acc, _mm256_loadu_si256((const __m256i*)Secret));
+
+    // There is no 64 bit multiply, multiply each 32 bit half by the prime and recombine
+    __m256i Prime = _mm256_set1_epi32((int)HASH_PRIME32);
+    __m256i Lo    = _mm256_mul_epu32(Acc, Prime);
+    __m256i Hi    = _mm256_mul_epu32(_mm256_srli_epi64(Acc, 32), Prime);
+    return _mm256_add_epi64(Lo, _mm256_slli_epi64(Hi, 32));
+}
+
+fn_internal void
+hash_consume_stripes_avx2(u64* Acc, u32* StripesInBlock, const u8* Data, u64 StripeCount)
+{
+    __m256i Acc0 = _mm256_loadu_si256((__m256i*)Acc);
+    __m256i Acc1 = _mm256_loadu_si256((__m256i*)(Acc + 4));
+
+    u32 InBlock = *StripesInBlock;
+    ForRange(u64, Stripe, StripeCount)
+    {
+        const u8*  Bytes  = Data + Stripe * HASH_STRIPE_SIZE;
+        const u64* Secret = cHashSecret + InBlock;
+        Acc0 = hash_accumulate_avx2(Acc0, Bytes,      Secret);
+        Acc1 = hash_accumulate_avx2(Acc1, Bytes + 32, Secret + 4);
+
+        if (++InBlock == HASH_STRIPES_PER_BLOCK)
+        {
+            Acc0 = hash_scramble_avx2(Acc0, HASH_FINAL_SECRET);
+            Acc1 = hash_scramble_avx2(Acc1, HASH_FINAL_SECRET + 4);
+            InBlock = 0;
+        }
+    }
+    *StripesInBlock = InBlock;
+
+    _mm256_storeu_si256((__m256i*)Acc,       Acc0);
+    _mm256_storeu_si256((__m256i*)(Acc + 4), Acc1);
+}
+#endif
+
+#if defined(__SSE2__)
+// Same as the AVX2 version on two lanes at a time
+fn_inline __m128i
+hash_accumulate_sse2(__m128i Acc, const u8* Data, const u64* Secret)
+{
+    __m128i Value   = _mm_loadu_si128((const __m128i*)Data);
+    __m128i Key     = _mm_xor_si128(Value, _mm_loadu_si128((const __m128i*)Secret));
+    __m128i Product = _mm_mul_epu32(Key, _mm_srli_epi64(Key, 32));
+    __m128i Swapped = _mm_shuffle_epi32(Value, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm_add_epi64(Acc, _mm_add_epi64(Product, Swapped));
+}
+
+fn_inline __m128i
+hash_scramble_sse2(__m128i Acc, const u64* Secret)
+{
+    Acc = _mm_xor_si128(Acc, _mm_srli_epi64(Acc, 47));
+    Acc = _mm_xor_si128(Acc, _mm_loadu_si128((const __m128i*)Secret));
+
+    __m128i Prime = _mm_set1_epi32((int)HASH_PRIME32);
+    __m128i Lo    = _mm_mul_epu32(Acc, Prime);
+    __m128i Hi    = _mm_mul_epu32(_mm_srli_epi64(Acc, 32), Prime);
+    return _mm_add_epi64(Lo, _mm_slli_epi64(Hi, 32));
+}
+
+fn_internal void
+hash_consume_stripes_sse2(u64* Acc, u32* StripesInBlock, const u8* Data, u64 StripeCount)
+{
+    __m128i Lanes[4];
+    ForRange(u32, i, 4) Lanes[i] = _mm_loadu_si128((__m128i*)(Acc + 2 * i));
+
+    u32 InBlock = *StripesInBlock;
+    ForRange(u64, Stripe, StripeCount)
+    {
+        const u8*  Bytes  = Data + Stripe * HASH_STRIPE_SIZE;
+        const u64* Secret = cHashSecret + InBlock;
+        ForRange(u32, i, 4) Lanes[i] = hash_accumulate_sse2(Lanes[i], Bytes + 16 * i, Secret + 2 * i);
+
+        if (++InBlock == HASH_STRIPES_PER_BLOCK)
+        {
+            ForRange(u32, i, 4) Lanes[i] = hash_scramble_sse2(Lanes[i], HASH_FINAL_SECRET + 2 * i);
+            InBlock = 0;
+        }
+    }
+    *StripesInBlock = InBlock;
+
+    ForRange(u32, i, 4) _mm_storeu_si128((__m128i*)(Acc + 2 * i), Lanes[i]);
+}
+#endif
+
+fn_inline void
+hash_consume_stripes(u64* Acc, u32* StripesInBlock, const u8* Data, u64 StripeCount)
+{
+#if defined(__AVX2__)
+    hash_consume_stripes_avx2(Acc, StripesInBlock, Data, StripeCount);
+#elif defined(__SSE2__)
+    hash_consume_stripes_sse2(Acc, StripesInBlock, Data, StripeCount);
+#else
+    hash_consume_stripes_scalar(Acc, StripesInBlock, Data, StripeCount);
+#endif
+}
+
+fn_internal u64
+hash_merge(u64* Acc, const u8* LastStripe, u64 Length)
+{
+    hash_accumulate_scalar(Acc, LastStripe, HASH_FINAL_SECRET);
+
+    u64 Result = Length * HASH_PRIME64_1;
+    ForRange(u32, i, 4)
+        Result += hash_mum(Acc[2 * i] ^ cHashSecret[2 * i + 3], Acc[2 * i + 1] ^ cHashSecret[2 * i + 4]);
+
+    return hash_avalanche(Result);
+}
+
+u64 hash_u64(u64 Value)
+{ // MurmurHash3 finalizer
+    Value ^= Value >> 33;
+    Value *= 0xff51afd7ed558ccdull;
+    Value ^= Value >> 33;
+    Value *= 0xc4ceb9fe1a85ec53ull;
+    Value ^= Value >> 33;
+    return Value;
+}
+
+typedef void hash_consume_fn(u64* Acc, u32* StripesInBlock, const u8* Data, u64 StripeCount);
+
+fn_inline u64
+hash_long(const u8* Bytes, u64 Length, hash_consume_fn* Consume)
+{
+    u64 Acc[8];
+    hash_acc_init(Acc);
+
+    // Every full stripe but the one holding the last byte, which is covered by the final stripe
+    u32 InBlock = 0;
+    Consume(Acc, &InBlock, Bytes, (Length - 1) / HASH_STRIPE_SIZE);
+    return hash_merge(Acc, Bytes + Length - HASH_STRIPE_SIZE, Length);
+}
+
+u64 hash_bytes(const void* Data, u64 Length)
+{
+    if (Length <= HASH_SHORT_MAX)
+        return hash_short((const u8*)Data, Length);
+    return hash_long((const u8*)Data, Length, hash_consume_stripes);
+}
+
+u64 hash_bytes_scalar(const void* Data, u64 Length)
+{
+    if (Length <= HASH_SHORT_MAX)
+        return hash_short((const u8*)Data, Length);
+    return hash_long((const u8*)Data, Length, hash_consume_stripes_scalar);
+}
+
+u64 hash_file_result(file_io_read_result* Result)
+{
+    if (Result->Error != file_io_none) return hash_bytes(NULL, 0);
+    return hash_bytes(Result->FileData, Result->FileSize);
+}
+
+void hash_state_init(hash_state* State)
+{
+    mem_zero(State, sizeof(hash_state));
+    hash_acc_init(State->Acc);
+}
+
+// Consumes whole stripes that are known not to hold the last byte of the input
+fn_internal void
+hash_state_consume(hash_state* State, const u8* Data, u64 Size)
+{
+    hash_consume_stripes(State->Acc, &State->StripesInBlock, Data, Size / HASH_STRIPE_SIZE);
+    mem_copy(State->LastStripe, Data + Size - HASH_STRIPE_SIZE, HASH_STRIPE_SIZE);
+}
+
+void hash_state_update(hash_state* State, const void* Data, u64 Length)
+{
+    const u8* Bytes = (const u8*)Data;
+    State->TotalLength += Length;
+
+    if (State->BufferedSize + Length <= HASH_BUFFER_SIZE)
+    {
+        mem_copy(State->Buffer + State->BufferedSize, Bytes, Length);
+        State->BufferedSize += (u32)Length;
+        return;
+    }
+
+    // There is input past the buffer, so all of it can be consumed
+    if (State->BufferedSize)
+    {
+        u64 Fill = HASH_BUFFER_SIZE - State->BufferedSize;
+        mem_copy(State->Buffer + State->BufferedSize, Bytes, Fill);
+        Bytes  += Fill;
+        Length -= Fill;
+
+        hash_state_consume(State, State->Buffer, HASH_BUFFER_SIZE);
+        State->BufferedSize = 0;
+    }
+
+    // Consume straight from the input, holding back the tail
+    if (Length > HASH_BUFFER_SIZE)
+    {
+        u64 Consume = ((Length - 1) / HASH_BUFFER_SIZE) * HASH_BUFFER_SIZE;
+        hash_state_consume(State, Bytes, Consume);
+        Bytes  += Consume;
+        Length -= Consume;
+    }
+
+    mem_copy(State->Buffer, Bytes, Length);
+    State->BufferedSize = (u32)Length;
+}
+
+u64 hash_state_digest(hash_state* State)
+{
+    // Nothing has been consumed yet, the whole input is in the buffer
+    if (State->TotalLength <= HASH_SHORT_MAX)
+        return hash_short(State->Buffer, State->TotalLength);
+
+    u64 Acc[8];
+    mem_copy(Acc, State->Acc, sizeof(Acc));
+    u32 InBlock = State->StripesInBlock;
+
+    u64 Buffered = State->BufferedSize;
+    hash_consume_stripes(Acc, &InBlock, State->Buffer, (Buffered - 1) / HASH_STRIPE_SIZE);
+
+    if (Buffered >= HASH_STRIPE_SIZE)
+        return hash_merge(Acc, State->Buffer + Buffered - HASH_STRIPE_SIZE, State->TotalLength);
+
+    // The final stripe starts in the last consumed stripe
+    u8 LastStripe[HASH_STRIPE_SIZE];
+    mem_copy(LastStripe, State->LastStripe + Buffered, HASH_STRIPE_SIZE - Buffered);
+    mem_copy(LastStripe + HASH_STRIPE_SIZE - Buffered, State->Buffer, Buffered);
+    return hash_merge(Acc, LastStripe, State->TotalLength);
+}
+
+//
+// Hash Map
+//
+
+// The top byte of the hash goes in the control bytes, 0 is reserved for empty slots.
+fn_inline u8 hash_control_byte(u64 Hash)
+{
+    u8 Byte = (u8)(Hash >> 56);
+    return Byte ? Byte : 1;
+}
+
+fn_inline u8 hash_overflow_bit(u64 Hash)
+{
+    return (u8)(1 << ((Hash >> 53) & 7));
+}
+
+// Bitmask of the slots in the group whose control byte is Byte.
+fn_inline u32 hash_group_match(u8* Group, u8 Byte)
+{
+#if defined(__SSE2__)
+    __m128i Control = _mm_load_si128((__m128i*)Group);
+    u32 Mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(Control, _mm_set1_epi8((char)Byte)));
+#else
+    u32 Mask = 0;
+    ForRange(u32, i, HASH_GROUP_SLOTS)
+        Mask |= (u32)(Group[i] == Byte) << i;
+#endif
+    return Mask & ((1u << HASH_GROUP_SLOTS) - 1);
+}
+
+fn_inline u8* hash_table_slot(hash_table* Table, u64 Index)
+{
+    return Table->Slots + Index * Table->SlotSize;
+}
+
+fn_inline u64 hash_table_slot_hash(hash_table* Table, u8* Slot)
+{
+    if (Table->KeyKind == hash_key_int)
+        return hash_u64(((hash_int_key*)Slot)->Key);
+    return ((hash_string_key*)Slot)->Hash;
+}
+
+fn_internal void
+hash_table_allocate(hash_table* Table, u64 GroupCount)
+{
+    u64 ControlSize = GroupCount * HASH_GROUP_SIZE;
+    u64 SlotsSize   = GroupCount * HASH_GROUP_SLOTS * Table->SlotSize;
+
+    if (Table->Arena)
+    {
+        Table->Control = arena_push_zero(Table->Arena, ControlSize, HASH_GROUP_SIZE);
+        Table->Slots   = arena_push(Table->Arena, SlotsSize, Table->SlotAlignment);
+        cassert_custom(Table->Control && Table->Slots, "Hash table arena is out of space.");
+    }
+    else
+    {
+        Table->Control = mem_alloc(u8, ControlSize);
+        Table->Slots   = mem_alloc(u8, SlotsSize);
+        mem_zero(Table->Control, ControlSize);
+    }
+
+    Table->GroupCount = GroupCount;
+    Table->Count      = 0;
+    Table->MaxLoad    = (GroupCount * HASH_GROUP_SLOTS * 7) / 8;
+}
+
+// Returns the index of the slot holding the key, or U64_MAX.
+fn_internal u64
+hash_table_find_index(hash_table* Table, u64 Hash, u64 IntKey, const char* StringKey, u64 StringLength)
+{
+    if (Table->Count == 0) return U64_MAX;
+
+    u8  Byte      = hash_control_byte(Hash);
+    u8  Overflow  = hash_overflow_bit(Hash);
+    u64 GroupMask = Table->GroupCount - 1;
+    u64 Group     = Hash & GroupMask;
+
+    // Triangular probing, visits every group once
+    for (u64 Step = 1; Step <= Table->GroupCount; ++Step)
+    {
+        u8* Control = Table->Control + Group * HASH_GROUP_SIZE;
+
+        u32 Match = hash_group_match(Control, Byte);
+        while (Match)
+        {
+            u64 Index = Group * HASH_GROUP_SLOTS + __builtin_ctz(Match);
+            u8* Slot  = hash_table_slot(Table, Index);
+
+            if (Table->KeyKind == hash_key_int)
+            {
+                if (((hash_int_key*)Slot)->Key == IntKey) return Index;
+            }
+            else
+            {
+                hash_string_key* Key = (hash_string_key*)Slot;
+                if (Key->Hash == Hash && Key->KeyLength == StringLength && 
+                    mem_cmp(Key->Key, StringKey, StringLength))
+                    return Index;
+            }
+
+            Match &= Match - 1;
+        }
+
+        // Nothing with this hash was pushed past the group
+        if (!(Control[HASH_GROUP_SLOTS] & Overflow)) break;
+        Group = (Group + Step) & GroupMask;
+    }
+
+    return U64_MAX;
+}
+
+// Claims the first empty slot along the probe sequence, setting the overflow bit of every full
+// group on the way. The caller makes sure the table has room.
+fn_internal u64
+hash_table_place(hash_table* Table, u64 Hash)
+{
+    u8  Byte      = hash_control_byte(Hash);
+    u8  Overflow  = hash_overflow_bit(Hash);
+    u64 GroupMask = Table->GroupCount - 1;
+    u64 Group     = Hash & GroupMask;
+
+    for (u64 Step = 1;; ++Step)
+    {
+        u8* Control = Table->Control + Group * HASH_GROUP_SIZE;
+
+        u32 Empty = hash_group_match(Control, 0);
+        if (Empty)
+        {
+            u32 Slot = __builtin_ctz(Empty);
+            Control[Slot] = Byte;
+            return Group * HASH_GROUP_SLOTS + Slot;
+        }
+
+        Control[HASH_GROUP_SLOTS] |= Overflow;
+        Group = (Group + Step) & GroupMask;
+    }
+}
+
+fn_internal void
+hash_table_rehash(hash_table* Table)
+{
+    // Double once the live entries take up more than half of the full max load. Below that the
+    // max load was lowered by removals, and rehashing at the same size clears the overflow bits.
+    u64 GroupCount  = Table->GroupCount;
+    u64 FullMaxLoad = (GroupCount * HASH_GROUP_SLOTS * 7) / 8;
+    if (Table->Count + 1 > FullMaxLoad / 2) GroupCount *= 2;
+
+    hash_table Old = *Table;
+    hash_table_allocate(Table, GroupCount);
+
+    ForRange(u64, Group, Old.GroupCount)
+    {
+        u8* Control = Old.Control + Group * HASH_GROUP_SIZE;
+        ForRange(u64, i, HASH_GROUP_SLOTS)
+        {
+            if (!Control[i]) continue;
+
+            u8* Slot  = hash_table_slot(&Old, Group * HASH_GROUP_SLOTS + i);
+            u64 Index = hash_table_place(Table, hash_table_slot_hash(&Old, Slot));
+            mem_copy(hash_table_slot(Table, Index), Slot, Table->SlotSize);
+        }
+    }
+    Table->Count = Old.Count;
+
+    if (!Old.Arena)
+    {
+        mem_free(Old.Control);
+        mem_free(Old.Slots);
+    }
+}
+
+fn_internal void*
+hash_table_insert(hash_table* Table, u64 Hash, u64 IntKey, const char* StringKey, u64 StringLength, bool* OutInserted)
+{
+    u64 Index = hash_table_find_index(Table, Hash, IntKey, StringKey, StringLength);
+    if (Index != U64_MAX)
+    {
+        if (OutInserted) *OutInserted = false;
+        return hash_table_slot(Table, Index);
+    }
+
+    if (Table->Count + 1 > Table->MaxLoad)
+        hash_table_rehash(Table);
+
+    Index = hash_table_place(Table, Hash);
+    Table->Count += 1;
+
+    u8* Slot = hash_table_slot(Table, Index);
+    if (Table->KeyKind == hash_key_int)
+    {
+        ((hash_int_key*)Slot)->Key = IntKey;
+    }
+    else
+    {
+        hash_string_key* Key = (hash_string_key*)Slot;
+        Key->Key       = StringKey;
+        Key->KeyLength = StringLength;
+        Key->Hash      = Hash;
+    }
+
+    if (OutInserted) *OutInserted = true;
+    return Slot;
+}
+
+fn_internal bool
+hash_table_remove(hash_table* Table, u64 Hash, u64 IntKey, const char* StringKey, u64 StringLength)
+{
+    u64 Index = hash_table_find_index(Table, Hash, IntKey, StringKey, StringLength);
+    if (Index == U64_MAX) return false;
+
+    u8* Control = Table->Control + (Index / HASH_GROUP_SLOTS) * HASH_GROUP_SIZE;
+    Control[Index % HASH_GROUP_SLOTS] = 0;
+    Table->Count -= 1;
+
+    // Probes may still pass through this group for the removed key's hash, so its overflow
+    // bits stay set. Count the slot against the max load until the next rehash clears them.
+    if (Control[HASH_GROUP_SLOTS])
+        Table->MaxLoad -= 1;
+
+    return true;
+}
+
+void hash_table_init(hash_table* Table, hash_key_kind KeyKind, u32 SlotSize, u32 SlotAlignment,
+                     memory_arena* Arena, u64 Capacity)
+{
+    mem_zero(Table, sizeof(hash_table));
+    Table->SlotSize      = SlotSize;
+    Table->SlotAlignment = SlotAlignment;
+    Table->KeyKind       = KeyKind;
+    Table->Arena         = Arena;
+
+    u64 GroupCount = ((Capacity * 8) / 7 + HASH_GROUP_SLOTS - 1) / HASH_GROUP_SLOTS;
+    GroupCount = next_highest_pow_2_u64(GroupCount);
+    if (GroupCount < HASH_MIN_GROUP_COUNT) GroupCount = HASH_MIN_GROUP_COUNT;
+
+    hash_table_allocate(Table, GroupCount);
+}
+
+void hash_table_free(hash_table* Table)
+{
+    if (!Table->Arena)
+    {
+        mem_free(Table->Control);
+        mem_free(Table->Slots);
+    }
+    mem_zero(Table, sizeof(hash_table));
+}
+
+void hash_table_clear(hash_table* Table)
+{
+    mem_zero(Table->Control, Table->GroupCount * HASH_GROUP_SIZE);
+    Table->Count   = 0;
+    Table->MaxLoad = (Table->GroupCount * HASH_GROUP_SLOTS * 7) / 8;
+}
+
+void* hash_table_find_int(hash_table* Table, u64 Key)
+{
+    u64 Index = hash_table_find_index(Table, hash_u64(Key), Key, NULL, 0);
+    return (Index != U64_MAX) ? hash_table_slot(Table, Index) : NULL;
+}
+
+void* hash_table_find_string(hash_table* Table, const char* Key, u64 KeyLength)
+{
+    u64 Index = hash_table_find_index(Table, hash_bytes(Key, KeyLength), 0, Key, KeyLength);
+    return (Index != U64_MAX) ? hash_table_slot(Table, Index) : NULL;
+}
+
+void* hash_table_insert_int(hash_table* Table, u64 Key, bool* OutInserted)
+{
+    return hash_table_insert(Table, hash_u64(Key), Key, NULL, 0, OutInserted);
+}
+
+void* hash_table_insert_string(hash_table* Table, const char* Key, u64 KeyLength, bool* OutInserted)
+{
+    return hash_table_insert(Table, hash_bytes(Key, KeyLength), 0, Key, KeyLength, OutInserted);
+}
+
+bool hash_table_remove_int(hash_table* Table, u64 Key)
+{
+    return hash_table_remove(Table, hash_u64(Key), Key, NULL, 0);
+}
+
+bool hash_table_remove_string(hash_table* Table, const char* Key, u64 KeyLength)
+{
+    return hash_table_remove(Table, hash_bytes(Key, KeyLength), 0, Key, KeyLength);
+}
+
+void* hash_table_next(hash_table* Table, u64* Cursor)
+{
+    u64 SlotCount = Table->GroupCount * HASH_GROUP_SLOTS;
+    while (*Cursor < SlotCount)
+    {
+        u64 Index = (*Cursor)++;
+        if (Table->Control[(Index / HASH_GROUP_SLOTS) * HASH_GROUP_SIZE + (Index % HASH_GROUP_SLOTS)])
+            return hash_table_slot(Table, Index);
+    }
+    return NULL;
 }
@@ -2,6 +2,8 @@
 #define _CHIBI_CORE_H_
 
 #include "chibi_types.h"
+#include "platform.h"
+#include <assert.h>
 
 #if defined(_NO_ASSERTS_)
 #  define cassert(Condition)
@@ -61,6 +63,14 @@ bool string_compare(
         const char* SourceA, u64 SourceASize,
         const char* SourceB, u64 SourceBSize);
 
+// Searches scan 32 bytes at a time with AVX2 and 16 with SSE2. Return the first match, or NULL.
+const char* string_find_byte(const char* String, u64 Length, char Byte);
+// First byte that is either A or B, i.e. '\r' or '\n' for line ends.
+const char* string_find_either_byte(const char* String, u64 Length, char A, char B);
+// Compares the first and last bytes of the needle against a block of candidate positions at
+// once and only checks the rest of the needle where both match.
+const char* string_find(const char* String, u64 Length, const char* Needle, u64 NeedleLength);
+
 // duplicate and ncopy allocate memory
 char* string_duplicate(const char* SourceString);
 
@@ -76,22 +86,392 @@ char* string_trim(char* Source);
 
 u64 string_read_to_delim(char* Destination, char* Source, char Delimiter);
 
+// Skip leading whitespace like sscanf did, then parse with the str_view parsers below. Return
+// false if there is no number or it doesn't fit. string_to_int also takes 0x hex and 0 octal.
 bool string_to_f32(char* Str, f32* OutF32);
 bool string_to_int(char* Str, s32* OutS32);
 bool string_uint(char* Str, u32* OutU32);
 
+//
+// String Views
+//
+// A pointer and a length in to memory the view doesn't own. Unlike the string_ functions above
+// nothing here allocates, writes through a view or needs a null terminator, so parsers can
+// tokenize straight over a loaded file.
+//
+
+typedef struct
+{
+    const char* Data;
+    u64         Length;
+} str_view;
+
+#define STR_VIEW_NOT_FOUND U64_MAX
+
+// View of a string literal, without the terminator
+#define str_lit(Literal) ((str_view){ (Literal), sizeof(Literal) - 1 })
+
+fn_inline str_view str_view_make(const char* Data, u64 Length) { return (str_view){ Data, Length }; }
+fn_inline str_view str_view_from_range(const char* Start, const char* End) { return (str_view){ Start, (u64)(End - Start) }; }
+str_view str_view_from_cstr(const char* String);
+
+// [Start, End) of the view, both are clamped to the view's length.
+str_view str_view_slice(str_view View, u64 Start, u64 End);
+// The first/last Count characters, clamped.
+str_view str_view_prefix(str_view View, u64 Count);
+str_view str_view_suffix(str_view View, u64 Count);
+// Drops the first Count characters, clamped.
+str_view str_view_skip(str_view View, u64 Count);
+
+bool str_view_equals(str_view Left, str_view Right);
+bool str_view_starts_with(str_view View, str_view Prefix);
+bool str_view_ends_with(str_view View, str_view Suffix);
+
+// Return the index of the first/last match, or STR_VIEW_NOT_FOUND.
+u64 str_view_find_char(str_view View, char Character);
+u64 str_view_find_last_char(str_view View, char Character);
+u64 str_view_find(str_view View, str_view Needle);
+
+// Trims spaces, tabs, carriage returns and newlines.
+str_view str_view_trim_left(str_view View);
+str_view str_view_trim_right(str_view View);
+str_view str_view_trim(str_view View);
+
+// Returns the text before the first Delimiter and advances View past the delimiter, or returns
+// all of View and leaves it empty if there is no delimiter.
+str_view str_view_chop(str_view* View, char Delimiter);
+// Chops the next line off of View, dropping a trailing carriage return. Returns false once View
+// is empty, so a final newline doesn't produce an extra empty line.
+bool str_view_next_line(str_view* View, str_view* OutLine);
+
+// Iterates the tokens between delimiters: "a,,b" splits in to "a", "" and "b".
+typedef struct
+{
+    str_view Remaining;
+    char     Delimiter;
+    bool     Done;
+} str_split_iter;
+
+str_split_iter str_view_split(str_view View, char Delimiter);
+// Returns false once every token has been returned.
+bool str_split_next(str_split_iter* Iter, str_view* OutToken);
+
+//
+// Number parsing
+//
+// Parse a number from the start of the view, without skipping whitespace. OutConsumed receives
+// the number of bytes that make up the number (0 unless the result is parse_number_ok).
+// Integers are decimal with an optional sign and are converted 8 digits at a time. Floats take
+// an optional fraction and exponent; values that are exact in a double (at most 19 significant
+// digits, mantissa <= 2^53, |exponent| <= 22; 2^24 and 10 for f32) are converted directly,
+// anything else, including inf and nan, falls back to strtod/strtof.
+//
+
+typedef enum
+{
+    parse_number_ok,
+    parse_number_invalid,  // The view doesn't start with a number
+    parse_number_overflow, // The number doesn't fit in the type
+} parse_number_error;
+
+parse_number_error str_view_parse_u64(str_view View, u64* OutValue, u64* OutConsumed);
+parse_number_error str_view_parse_s64(str_view View, s64* OutValue, u64* OutConsumed);
+parse_number_error str_view_parse_f64(str_view View, f64* OutValue, u64* OutConsumed);
+parse_number_error str_view_parse_f32(str_view View, f32* OutValue, u64* OutConsumed);
+
+// Bulk integer extraction. Finds every integer in Text in one pass, scanning 32 bytes at a time
+// for the start of each run of digits. A '-' right before the digits makes the value negative,
+// unless it follows a digit, so ranges like "3-5" give 3 and 5. Values that don't fit in an s64
+// wrap.
+//
+// Only the first ValueCapacity values are written, ValueCount is the total so a caller can size
+// the array and scan again. If OutLineOffsets isn't NULL it receives the index of the first
+// value on each line followed by ValueCount, so line i owns the values in
+// [OutLineOffsets[i], OutLineOffsets[i + 1]). A trailing newline doesn't start a new line.
+// Only the first LineOffsetCapacity offsets are written, LineCount + 1 are needed. Lines are
+// only counted when OutLineOffsets isn't NULL, LineCount is 1 otherwise.
+
+typedef struct
+{
+    u64 ValueCount;
+    u64 LineCount;
+} integer_extract_result;
+
+integer_extract_result str_view_extract_integers(str_view Text, s64* OutValues, u64 ValueCapacity,
+                                                 u64* OutLineOffsets, u64 LineOffsetCapacity);
+// Returns the same counts as str_view_extract_integers without parsing any values, only the
+// digit and newline masks are built. Used to size the output arrays up front.
+integer_extract_result str_view_count_integers(str_view Text);
+
+// Multi-pattern matcher (Aho-Corasick). Built once from a list of words into a table driven
+// DFA, every failure link is resolved at build time so matching is a single table lookup per
+// byte. A matcher built with Reverse set matches the words back to front and is meant to be
+// used with string_matcher_find_last.
+typedef struct
+{
+    u32  StateCount;
+    u16* Transitions; // StateCount * 256 entries
+    s32* Matches;     // Per state, the id of the word that ends in that state or -1
+    u32* WordLengths;
+    bool Reverse;
+} string_matcher;
+
+// Word ids are the index of the word in Words. Allocates memory, free with string_matcher_free.
+string_matcher string_matcher_build(const char** Words, u32 WordCount, bool Reverse);
+void string_matcher_free(string_matcher* Matcher);
+
+// Returns the id of the first word to complete while scanning forward through Stream, or -1
+// if there is no match. OutPosition receives the index of the first byte of the match.
+s32 string_matcher_find_first(string_matcher* Matcher, const char* Stream, u64 Length, u64* OutPosition);
+// Returns the id of the first word to complete while scanning backwards through Stream, or -1
+// if there is no match. Requires a Reverse matcher.
+s32 string_matcher_find_last(string_matcher* Matcher, const char* Stream, u64 Length, u64* OutPosition);
+
+//
+// Memory Arena
+//
+// Linear allocator over a reserved range of address space. Pages are committed on demand as
+// the arena grows, so reserving a large range up front only costs address space. Memory is
+// released all at once with arena_reset, or back to a marker with arena_pop_to_marker.
+//
+
+#define ARENA_DEFAULT_RESERVE_SIZE _GB(64)
+#define ARENA_COMMIT_SIZE          _64KB // Granularity of commits, a multiple of the page size
+#define ARENA_DEFAULT_ALIGNMENT    16
+
+typedef struct
+{
+    u8* Base;
+    u64 ReserveSize;
+    u64 CommitSize;
+    u64 Pos;
+} memory_arena;
+
+typedef struct
+{
+    memory_arena* Arena;
+    u64           Pos;
+} arena_marker;
+
+#define arena_push_array(Arena, Type, Count)      (Type*)arena_push(Arena, sizeof(Type) * (Count), _Alignof(Type))
+#define arena_push_array_zero(Arena, Type, Count) (Type*)arena_push_zero(Arena, sizeof(Type) * (Count), _Alignof(Type))
+
+// If the range can't be reserved the arena's Base is NULL and every push returns NULL. Does
+// not log, for the same reason as arena_push.
+memory_arena arena_init(u64 ReserveSize);
+void arena_release(memory_arena* Arena);
+
+// Returns NULL if the arena's reserved range is exhausted. Memory is not zeroed.
+// Does not log, the logger itself allocates from scratch arenas.
+void* arena_push(memory_arena* Arena, u64 Size, u64 Alignment);
+void* arena_push_zero(memory_arena* Arena, u64 Size, u64 Alignment);
+
+arena_marker arena_get_marker(memory_arena* Arena);
+void arena_pop_to_marker(arena_marker Marker);
+// Releases every allocation, committed pages are kept for reuse.
+void arena_reset(memory_arena* Arena);
+
+// Scratch arenas for temporary allocations. Every thread has two, so a function handed a
+// scratch arena by its caller can still get one of its own by passing the caller's arena as
+// a conflict. Everything pushed after scratch_begin is released by scratch_end.
+#define SCRATCH_ARENA_COUNT        2
+#define SCRATCH_ARENA_RESERVE_SIZE _GB(1)
+
+arena_marker scratch_begin(memory_arena** Conflicts, u32 ConflictCount);
+void scratch_end(arena_marker Scratch);
+
+// Binds an arena to the calling thread, mem_alloc then allocates from it. Pass NULL to go back
+// to the heap. Returns the previously bound arena. mem_free ignores pointers in to any arena
+// that has been bound, on every thread, until the arena is released.
+memory_arena* chibi_memory_bind_arena(memory_arena* Arena);
+
 #define mem_alloc(Type, Count)              (Type*)chibi_memory_alloc(sizeof(Type) * (Count))
 #define mem_free(Memory)                    chibi_memory_free((void*)Memory)
 #define mem_set(Memory, Value, Size)        chibi_memory_set((void*)Memory, Value, Size)
 #define mem_zero(Memory, Size)              chibi_memory_set((void*)Memory, 0, Size)
 #define mem_copy(Destination, Source, Size) chibi_memory_copy((void*)Destination, (void*)Source, Size)
+#define mem_move(Destination, Source, Size) chibi_memory_move((void*)Destination, (void*)Source, Size)
 #define mem_cmp(Left, Right, Size)          chibi_memory_cmp((void*)Left, (void*)Right, Size)
 
 void* chibi_memory_alloc(u64 Size);
 void  chibi_memory_free(void* Memory);
 void  chibi_memory_set(void* Memory, int Value, u64 Size);
 void  chibi_memory_copy(void* Destination, void* Source, u64 Size);
+// Like copy, but Destination and Source may overlap
+void  chibi_memory_move(void* Destination, void* Source, u64 Size);
 bool  chibi_memory_cmp(void* Left, void* Right, u64 Size);
 
+//
+// Hashing
+//
+// Fast non-cryptographic 64 bit hash in the style of XXH3. Inputs up to HASH_SHORT_MAX bytes are
+// mixed directly with 128 bit multiplies. Longer inputs are consumed 64 byte stripes at a time
+// by 8 accumulators that are scrambled every HASH_STRIPES_PER_BLOCK stripes, the stripe loop has
+// AVX2, SSE2 and scalar versions that give the same result. The last stripe is always the final
+// 64 bytes of the input. The streaming api gives the same hash as hash_bytes no matter how the
+// input is split between updates.
+//
+
+#define HASH_STRIPE_SIZE       64
+#define HASH_STRIPES_PER_BLOCK 16
+#define HASH_SHORT_MAX         128
+#define HASH_BUFFER_SIZE       256 // Streamed bytes are held back until there is more input behind them
+
+typedef struct
+{
+    u64 Acc[8];
+    u64 TotalLength;
+    u32 StripesInBlock;
+    u32 BufferedSize;
+    u8  Buffer[HASH_BUFFER_SIZE];
+    u8  LastStripe[HASH_STRIPE_SIZE]; // Last consumed stripe, for when less than a stripe is buffered
+} hash_state;
+
+u64 hash_u64(u64 Value);
+u64 hash_bytes(const void* Data, u64 Length);
+// Same result as hash_bytes without the vector stripe loop, for testing and benchmarks.
+u64 hash_bytes_scalar(const void* Data, u64 Length);
+// Hashes the file contents, a failed read hashes as empty.
+u64 hash_file_result(file_io_read_result* Result);
+
+void hash_state_init(hash_state* State);
+void hash_state_update(hash_state* State, const void* Data, u64 Length);
+// Does not modify the state, more data can be added after a digest.
+u64  hash_state_digest(hash_state* State);
+
+//
+// Hash Map
+//
+// Open addressing table in the style of a swiss table. Control bytes are kept in groups of 16,
+// 15 bytes hold a byte of each slot's hash (0 marks an empty slot) and the last byte holds
+// overflow bits. A lookup compares a whole group at once with SSE2 and only moves on to the
+// next group if the overflow bit for its hash is set, which an insert sets on every full group
+// it passes. Removing an entry just empties its slot, there are no tombstones. Removing from a
+// group that has overflowed lowers the max load instead, so the next growth rehashes the table
+// and clears the stale overflow bits.
+//
+// Entries start with the key fields of hash_int_key or hash_string_key, followed by the value.
+// String keys are not copied, the key memory must outlive the table. Storage comes from
+// Arena when one is given (old storage is abandoned on growth) and mem_alloc otherwise.
+// The HASH_MAP_DEFINE macros generate typed wrappers.
+//
+
+#define HASH_GROUP_SIZE      16
+#define HASH_GROUP_SLOTS     15 // The last control byte of a group holds its overflow bits
+#define HASH_MIN_GROUP_COUNT 2
+
+typedef enum
+{
+    hash_key_int,
+    hash_key_string,
+} hash_key_kind;
+
+typedef struct
+{
+    u64 Key;
+} hash_int_key;
+
+typedef struct
+{
+    const char* Key;
+    u64         KeyLength;
+    u64         Hash; // Kept so growth doesn't rehash the strings
+} hash_string_key;
+
+typedef struct
+{
+    u8* Control;    // GroupCount * HASH_GROUP_SIZE bytes
+    u8* Slots;      // GroupCount * HASH_GROUP_SLOTS entries
+    u64 GroupCount; // Power of 2
+    u64 Count;
+    u64 MaxLoad;    // Count that triggers growth
+
+    u32           SlotSize;
+    u32           SlotAlignment;
+    hash_key_kind KeyKind;
+    memory_arena* Arena;
+} hash_table;
+
+// Capacity is the number of entries to make room for up front, Arena may be NULL.
+void  hash_table_init(hash_table* Table, hash_key_kind KeyKind, u32 SlotSize, u32 SlotAlignment,
+                      memory_arena* Arena, u64 Capacity);
+void  hash_table_free(hash_table* Table);
+// Removes every entry, keeping the storage.
+void  hash_table_clear(hash_table* Table);
+
+// Return the entry for the key, or NULL.
+void* hash_table_find_int(hash_table* Table, u64 Key);
+void* hash_table_find_string(hash_table* Table, const char* Key, u64 KeyLength);
+// Return the entry for the key, adding it if it isn't in the table. OutInserted is set when the
+// entry is new, its value is left uninitialized. Entry pointers are invalidated by growth.
+void* hash_table_insert_int(hash_table* Table, u64 Key, bool* OutInserted);
+void* hash_table_insert_string(hash_table* Table, const char* Key, u64 KeyLength, bool* OutInserted);
+// Return false if the key wasn't in the table.
+bool  hash_table_remove_int(hash_table* Table, u64 Key);
+bool  hash_table_remove_string(hash_table* Table, const char* Key, u64 KeyLength);
+
+// Walks the entries in storage order. Start Cursor at 0, returns NULL once done.
+void* hash_table_next(hash_table* Table, u64* Cursor);
+
+#define HASH_MAP_DEFINE_INT(ValueType, Name)                                                                        \
+    typedef struct { u64 Key; ValueType Value; } hash_map_##Name##_entry;                                           \
+    typedef struct { hash_table Table; } hash_map_##Name;                                                           \
+                                                                                                                    \
+    fn_inline void hash_map_##Name##_init(hash_map_##Name* Map, memory_arena* Arena, u64 Capacity)                  \
+    {                                                                                                               \
+        hash_table_init(&Map->Table, hash_key_int, sizeof(hash_map_##Name##_entry),                                 \
+                        _Alignof(hash_map_##Name##_entry), Arena, Capacity);                                        \
+    }                                                                                                               \
+    fn_inline ValueType* hash_map_##Name##_get(hash_map_##Name* Map, u64 Key)                                       \
+    {                                                                                                               \
+        hash_map_##Name##_entry* Entry = (hash_map_##Name##_entry*)hash_table_find_int(&Map->Table, Key);           \
+        return Entry ? &Entry->Value : NULL;                                                                        \
+    }                                                                                                               \
+    fn_inline ValueType* hash_map_##Name##_put(hash_map_##Name* Map, u64 Key, ValueType Value)                      \
+    {                                                                                                               \
+        bool Inserted;                                                                                              \
+        hash_map_##Name##_entry* Entry = (hash_map_##Name##_entry*)hash_table_insert_int(&Map->Table, Key, &Inserted); \
+        Entry->Value = Value;                                                                                       \
+        return &Entry->Value;                                                                                       \
+    }                                                                                                               \
+    fn_inline bool hash_map_##Name##_remove(hash_map_##Name* Map, u64 Key)                                          \
+    { return hash_table_remove_int(&Map->Table, Key); }                                                             \
+    fn_inline hash_map_##Name##_entry* hash_map_##Name##_next(hash_map_##Name* Map, u64* Cursor)                    \
+    { return (hash_map_##Name##_entry*)hash_table_next(&Map->Table, Cursor); }                                      \
+    fn_inline u64  hash_map_##Name##_count(hash_map_##Name* Map) { return Map->Table.Count; }                       \
+    fn_inline void hash_map_##Name##_clear(hash_map_##Name* Map) { hash_table_clear(&Map->Table); }                 \
+    fn_inline void hash_map_##Name##_free(hash_map_##Name* Map)  { hash_table_free(&Map->Table); }
+
+#define HASH_MAP_DEFINE_STRING(ValueType, Name)                                                                     \
+    typedef struct { const char* Key; u64 KeyLength; u64 Hash; ValueType Value; } hash_map_##Name##_entry;          \
+    typedef struct { hash_table Table; } hash_map_##Name;                                                           \
+                                                                                                                    \
+    fn_inline void hash_map_##Name##_init(hash_map_##Name* Map, memory_arena* Arena, u64 Capacity)                  \
+    {                                                                                                               \
+        hash_table_init(&Map->Table, hash_key_string, sizeof(hash_map_##Name##_entry),                              \
+                        _Alignof(hash_map_##Name##_entry), Arena, Capacity);                                        \
+    }                                                                                                               \
+    fn_inline ValueType* hash_map_##Name##_get(hash_map_##Name* Map, const char* Key, u64 KeyLength)                \
+    {                                                                                                               \
+        hash_map_##Name##_entry* Entry =                                                                            \
+            (hash_map_##Name##_entry*)hash_table_find_string(&Map->Table, Key, KeyLength);                          \
+        return Entry ? &Entry->Value : NULL;                                                                        \
+    }                                                                                                               \
+    fn_inline ValueType* hash_map_##Name##_put(hash_map_##Name* Map, const char* Key, u64 KeyLength, ValueType Value) \
+    {                                                                                                               \
+        bool Inserted;                                                                                              \
+        hash_map_##Name##_entry* Entry =                                                                            \
+            (hash_map_##Name##_entry*)hash_table_insert_string(&Map->Table, Key, KeyLength, &Inserted);             \
+        Entry->Value = Value;                                                                                       \
+        return &Entry->Value;                                                                                       \
+    }                                                                                                               \
+    fn_inline bool hash_map_##Name##_remove(hash_map_##Name* Map, const char* Key, u64 KeyLength)                   \
+    { return hash_table_remove_string(&Map->Table, Key, KeyLength); }                                               \
+    fn_inline hash_map_##Name##_entry* hash_map_##Name##_next(hash_map_##Name* Map, u64* Cursor)                    \
+    { return (hash_map_##Name##_entry*)hash_table_next(&Map->Table, Cursor); }                                      \
+    fn_inline u64  hash_map_##Name##_count(hash_map_##Name* Map) { return Map->Table.Count; }                       \
+    fn_inline void hash_map_##Name##_clear(hash_map_##Name* Map) { hash_table_clear(&Map->Table); }                 \
+    fn_inline void hash_map_##Name##_free(hash_map_##Name* Map)  { hash_table_free(&Map->Table); }
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "chibi_memory.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+
+// The vector the size classes are counted in, 32 bytes with AVX2 and 16 with SSE2
+#if defined(__AVX2__)
+#  define MEMORY_VECTOR_WIDTH 32
+typedef __m256i memory_vector;
+
+fn_inline memory_vector memory_splat(u8 Value)                      { return _mm256_set1_epi8((char)Value); }
+fn_inline memory_vector memory_load(const u8* Memory)               { return _mm256_loadu_si256((const __m256i*)Memory); }
+fn_inline void          memory_store(u8* Memory, memory_vector V)   { _mm256_storeu_si256((__m256i*)Memory, V); }
+fn_inline void          memory_stream(u8* Memory, memory_vector V)  { _mm256_stream_si256((__m256i*)Memory, V); }
+fn_inline memory_vector memory_and(memory_vector A, memory_vector B) { return _mm256_and_si256(A, B); }
+// All ones where the bytes of A and B match
+fn_inline memory_vector memory_match(const u8* A, const u8* B)     { return _mm256_cmpeq_epi8(memory_load(A), memory_load(B)); }
+fn_inline bool          memory_all_match(memory_vector Match)       { return (u32)_mm256_movemask_epi8(Match) == 0xFFFFFFFFu; }
+#else
+#  define MEMORY_VECTOR_WIDTH 16
+typedef __m128i memory_vector;
+
+fn_inline memory_vector memory_splat(u8 Value)                      { return _mm_set1_epi8((char)Value); }
+fn_inline memory_vector memory_load(const u8* Memory)               { return _mm_loadu_si128((const __m128i*)Memory); }
+fn_inline void          memory_store(u8* Memory, memory_vector V)   { _mm_storeu_si128((__m128i*)Memory, V); }
+fn_inline void          memory_stream(u8* Memory, memory_vector V)  { _mm_stream_si128((__m128i*)Memory, V); }
+fn_inline memory_vector memory_and(memory_vector A, memory_vector B) { return _mm_and_si128(A, B); }
+fn_inline memory_vector memory_match(const u8* A, const u8* B)     { return _mm_cmpeq_epi8(memory_load(A), memory_load(B)); }
+fn_inline bool          memory_all_match(memory_vector Match)       { return _mm_movemask_epi8(Match) == 0xFFFF; }
+#endif
+
+// Sizes up to this are handled inline with at most 8 vectors and no loop
+#define MEMORY_INLINE_LIMIT (8 * MEMORY_VECTOR_WIDTH)
+
+// Between the inline sizes and the streaming threshold the C library wins. It picks its loop
+// for the CPU it runs on at load time (wider vectors, rep movsb), which a build for a fixed
+// instruction set can't.
+fn_inline bool
+memory_use_libc(u64 Size)
+{
+    return Size - (MEMORY_INLINE_LIMIT + 1) < MEMORY_NON_TEMPORAL_THRESHOLD - (MEMORY_INLINE_LIMIT + 1);
+}
+
+// Under 32 bytes. Each size class stores its width twice, once at the start and once ending at
+// the end, the two overlap for sizes that aren't a power of 2.
+fn_inline void
+memory_set_small(u8* Memory, u8 Value, u64 Size)
+{
+    u64 Pattern = 0x0101010101010101ull * Value;
+    if (Size >= 16)
+    {
+        __m128i Vector = _mm_set1_epi8((char)Value);
+        _mm_storeu_si128((__m128i*)Memory,               Vector);
+        _mm_storeu_si128((__m128i*)(Memory + Size - 16), Vector);
+    }
+    else if (Size >= 8)
+    {
+        memcpy(Memory,            &Pattern, 8);
+        memcpy(Memory + Size - 8, &Pattern, 8);
+    }
+    else if (Size >= 4)
+    {
+        u32 Word = (u32)Pattern;
+        memcpy(Memory,            &Word, 4);
+        memcpy(Memory + Size - 4, &Word, 4);
+    }
+    else if (Size > 0)
+    { // First, middle and last cover 1 to 3 bytes
+        Memory[0]        = Value;
+        Memory[Size / 2] = Value;
+        Memory[Size - 1] = Value;
+    }
+}
+
+// Under 32 bytes, both ends are loaded before either is stored
+fn_inline void
+memory_copy_small(u8* Destination, const u8* Source, u64 Size)
+{
+    if (Size >= 16)
+    {
+        __m128i Head = _mm_loadu_si128((const __m128i*)Source);
+        __m128i Tail = _mm_loadu_si128((const __m128i*)(Source + Size - 16));
+        _mm_storeu_si128((__m128i*)Destination,               Head);
+        _mm_storeu_si128((__m128i*)(Destination + Size - 16), Tail);
+    }
+    else if (Size >= 8)
+    {
+        u64 Head, Tail;
+        memcpy(&Head, Source,            8);
+        memcpy(&Tail, Source + Size - 8, 8);
+        memcpy(Destination,            &Head, 8);
+        memcpy(Destination + Size - 8, &Tail, 8);
+    }
+    else if (Size >= 4)
+    {
+        u32 Head, Tail;
+        memcpy(&Head, Source,            4);
+        memcpy(&Tail, Source + Size - 4, 4);
+        memcpy(Destination,            &Head, 4);
+        memcpy(Destination + Size - 4, &Tail, 4);
+    }
+    else if (Size > 0)
+    {
+        u8 First  = Source[0];
+        u8 Middle = Source[Size / 2];
+        u8 Last   = Source[Size - 1];
+        Destination[0]        = First;
+        Destination[Size / 2] = Middle;
+        Destination[Size - 1] = Last;
+    }
+}
+
+// Under 32 bytes, same overlapping head and tail as memory_set_small
+fn_inline bool
+memory_equal_small(const u8* Left, const u8* Right, u64 Size)
+{
+    if (Size >= 16)
+    {
+        __m128i Head = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)Left), _mm_loadu_si128((const __m128i*)Right));
+        __m128i Tail = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(Left + Size - 16)),
+                                      _mm_loadu_si128((const __m128i*)(Right + Size - 16)));
+        return _mm_movemask_epi8(_mm_and_si128(Head, Tail)) == 0xFFFF;
+    }
+    if (Size >= 8)
+    {
+        u64 LeftHead, LeftTail, RightHead, RightTail;
+        memcpy(&LeftHead,  Left,             8);
+        memcpy(&LeftTail,  Left + Size - 8,  8);
+        memcpy(&RightHead, Right,            8);
+        memcpy(&RightTail, Right + Size - 8, 8);
+        return ((LeftHead ^ RightHead) | (LeftTail ^ RightTail)) == 0;
+    }
+    if (Size >= 4)
+    {
+        u32 LeftHead, LeftTail, RightHead, RightTail;
+        memcpy(&LeftHead,  Left,             4);
+        memcpy(&LeftTail,  Left + Size - 4,  4);
+        memcpy(&RightHead, Right,            4);
+        memcpy(&RightTail, Right + Size - 4, 4);
+        return ((LeftHead ^ RightHead) | (LeftTail ^ RightTail)) == 0;
+    }
+    if (Size > 0)
+        return Left[0] == Right[0] && Left[Size / 2] == Right[Size / 2] && Left[Size - 1] == Right[Size - 1];
+    return true;
+}
+
+// Count vectors from the start and Count ending at the end, for Size up to 2 * Count vectors.
+// Count is a constant at every call, so these unroll to straight-line code.
+fn_inline void
+memory_set_ends(u8* Memory, memory_vector Vector, u64 Size, u64 Count)
+{
+    ForRange(u64, i, Count)
+    {
+        memory_store(Memory + i * MEMORY_VECTOR_WIDTH,              Vector);
+        memory_store(Memory + Size - (i + 1) * MEMORY_VECTOR_WIDTH, Vector);
+    }
+}
+
+fn_inline void
+memory_copy_ends(u8* Destination, const u8* Source, u64 Size, u64 Count)
+{
+    ForRange(u64, i, Count)
+    {
+        u64 Tail = Size - (i + 1) * MEMORY_VECTOR_WIDTH;
+        memory_store(Destination + i * MEMORY_VECTOR_WIDTH, memory_load(Source + i * MEMORY_VECTOR_WIDTH));
+        memory_store(Destination + Tail,                    memory_load(Source + Tail));
+    }
+}
+
+fn_inline bool
+memory_equal_ends(const u8* Left, const u8* Right, u64 Size, u64 Count)
+{
+    memory_vector Match = memory_match(Left, Right);
+    memory_vector Tail  = memory_match(Left + Size - MEMORY_VECTOR_WIDTH, Right + Size - MEMORY_VECTOR_WIDTH);
+    Match = memory_and(Match, Tail);
+    for (u64 i = 1; i < Count; ++i)
+    {
+        u64 Back = Size - (i + 1) * MEMORY_VECTOR_WIDTH;
+        Match = memory_and(Match, memory_match(Left + i * MEMORY_VECTOR_WIDTH, Right + i * MEMORY_VECTOR_WIDTH));
+        Match = memory_and(Match, memory_match(Left + Back, Right + Back));
+    }
+    return memory_all_match(Match);
+}
+
+// At or past MEMORY_NON_TEMPORAL_THRESHOLD. The head and tail are stored unaligned, the body
+// is streamed with stores aligned to the vector width.
+fn_internal void
+memory_set_stream(u8* Memory, memory_vector Vector, u64 Size)
+{
+    u8* End  = Memory + Size;
+    u8* Iter = (u8*)(((uptr)Memory + MEMORY_VECTOR_WIDTH) & ~(uptr)(MEMORY_VECTOR_WIDTH - 1));
+    memory_store(Memory, Vector);
+
+    for (; Iter + 4 * MEMORY_VECTOR_WIDTH <= End; Iter += 4 * MEMORY_VECTOR_WIDTH)
+    {
+        memory_stream(Iter,                           Vector);
+        memory_stream(Iter + MEMORY_VECTOR_WIDTH,     Vector);
+        memory_stream(Iter + 2 * MEMORY_VECTOR_WIDTH, Vector);
+        memory_stream(Iter + 3 * MEMORY_VECTOR_WIDTH, Vector);
+    }
+    for (; Iter + MEMORY_VECTOR_WIDTH <= End; Iter += MEMORY_VECTOR_WIDTH)
+        memory_stream(Iter, Vector);
+    _mm_sfence(); // Streaming stores are weakly ordered
+
+    memory_store(End - MEMORY_VECTOR_WIDTH, Vector);
+}
+
+fn_internal void
+memory_copy_stream(u8* Destination, const u8* Source, u64 Size)
+{
+    memory_vector Head = memory_load(Source);
+    memory_vector Tail = memory_load(Source + Size - MEMORY_VECTOR_WIDTH);
+
+    u64       Skip = MEMORY_VECTOR_WIDTH - ((uptr)Destination & (MEMORY_VECTOR_WIDTH - 1));
+    u8*       Dst  = Destination + Skip;
+    const u8* Src  = Source + Skip;
+    u8*       End  = Destination + Size - MEMORY_VECTOR_WIDTH; // The tail store covers the rest
+
+    for (; Dst + 4 * MEMORY_VECTOR_WIDTH <= End; Dst += 4 * MEMORY_VECTOR_WIDTH, Src += 4 * MEMORY_VECTOR_WIDTH)
+    {
+        memory_vector A = memory_load(Src);
+        memory_vector B = memory_load(Src + MEMORY_VECTOR_WIDTH);
+        memory_vector C = memory_load(Src + 2 * MEMORY_VECTOR_WIDTH);
+        memory_vector D = memory_load(Src + 3 * MEMORY_VECTOR_WIDTH);
+        memory_stream(Dst,                           A);
+        memory_stream(Dst + MEMORY_VECTOR_WIDTH,     B);
+        memory_stream(Dst + 2 * MEMORY_VECTOR_WIDTH, C);
+        memory_stream(Dst + 3 * MEMORY_VECTOR_WIDTH, D);
+    }
+    for (; Dst < End; Dst += MEMORY_VECTOR_WIDTH, Src += MEMORY_VECTOR_WIDTH)
+        memory_stream(Dst, memory_load(Src));
+    _mm_sfence();
+
+    memory_store(Destination, Head);
+    memory_store(Destination + Size - MEMORY_VECTOR_WIDTH, Tail);
+}
+
+void memory_set(void* Memory, u8 Value, u64 Size)
+{
+    if (memory_use_libc(Size))
+    {
+        memset(Memory, Value, Size);
+        return;
+    }
+
+    u8* Bytes = (u8*)Memory;
+    if (Size < 32)
+    {
+        memory_set_small(Bytes, Value, Size);
+        return;
+    }
+
+    memory_vector Vector = memory_splat(Value);
+    if      (Size <= 2 * MEMORY_VECTOR_WIDTH) memory_set_ends(Bytes, Vector, Size, 1);
+    else if (Size <= 4 * MEMORY_VECTOR_WIDTH) memory_set_ends(Bytes, Vector, Size, 2);
+    else if (Size <= MEMORY_INLINE_LIMIT)     memory_set_ends(Bytes, Vector, Size, 4);
+    else                                      memory_set_stream(Bytes, Vector, Size);
+}
+
+void memory_copy(void* Destination, const void* Source, u64 Size)
+{
+    if (memory_use_libc(Size))
+    {
+        memcpy(Destination, Source, Size);
+        return;
+    }
+
+    u8*       Dst = (u8*)Destination;
+    const u8* Src = (const u8*)Source;
+    if      (Size < 32)                       memory_copy_small(Dst, Src, Size);
+    else if (Size <= 2 * MEMORY_VECTOR_WIDTH) memory_copy_ends(Dst, Src, Size, 1);
+    else if (Size <= 4 * MEMORY_VECTOR_WIDTH) memory_copy_ends(Dst, Src, Size, 2);
+    else if (Size <= MEMORY_INLINE_LIMIT)     memory_copy_ends(Dst, Src, Size, 4);
+    else                                      memory_copy_stream(Dst, Src, Size);
+}
+
+bool memory_equal(const void* LeftMemory, const void* RightMemory, u64 Size)
+{
+    // There's no streaming compare, everything past the inline sizes goes to the C library
+    if (Size > MEMORY_INLINE_LIMIT)
+        return memcmp(LeftMemory, RightMemory, Size) == 0;
+
+    const u8* Left  = (const u8*)LeftMemory;
+    const u8* Right = (const u8*)RightMemory;
+    if      (Size < 32)                       return memory_equal_small(Left, Right, Size);
+    else if (Size <= 2 * MEMORY_VECTOR_WIDTH) return memory_equal_ends(Left, Right, Size, 1);
+    else if (Size <= 4 * MEMORY_VECTOR_WIDTH) return memory_equal_ends(Left, Right, Size, 2);
+    else                                      return memory_equal_ends(Left, Right, Size, 4);
+}
+
+#else
+
+void memory_set(void* Memory, u8 Value, u64 Size)
+{
+    memset(Memory, Value, Size);
+}
+
+void memory_copy(void* Destination, const void* Source, u64 Size)
+{
+    memcpy(Destination, Source, Size);
+}
+
+bool memory_equal(const void* Left, const void* Right, u64 Size)
+{
+    return memcmp(Left, Right, Size) == 0;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef _CHIBI_MEMORY_H_
+#define _CHIBI_MEMORY_H_
+
+#include "chibi_types.h"
+
+//
+// Memory Primitives
+//
+// Set, copy and compare with AVX2, or SSE2 in the default build, dispatched on size class:
+// - Under 32 bytes: a pair of overlapping operations covering the head and tail, no loops.
+// - Up to 8 vectors (256 bytes with AVX2, 128 with SSE2): 1, 2 or 4 vectors from each end,
+//   overlapping in the middle, no loops.
+// - Larger: the C library, which picks its loop for the CPU it runs on at load time.
+// - At or past MEMORY_NON_TEMPORAL_THRESHOLD: set and copy use streaming stores that bypass
+//   the cache, so a huge copy doesn't evict everything else. Past that size the data wouldn't
+//   stay in cache anyway.
+//
+// Builds without SSE2 fall back to the C library.
+//
+// memory_copy does not handle overlapping ranges, use mem_move for those.
+//
+
+#if !defined(MEMORY_NON_TEMPORAL_THRESHOLD)
+#  define MEMORY_NON_TEMPORAL_THRESHOLD _MB(4)
+#endif
+
+void memory_set(void* Memory, u8 Value, u64 Size);
+void memory_copy(void* Destination, const void* Source, u64 Size);
+// True if the two ranges hold the same bytes.
+bool memory_equal(const void* Left, const void* Right, u64 Size);
+
+#endif //_CHIBI_MEMORY_H_
@@ -87,6 +87,7 @@ typedef union
 
 #define var_persist   static
 #define var_global    static
+#define var_thread_local _Thread_local
 
 #define _KB(x) ((x) * 1024llu)
 #define _MB(x) (_KB(x) * 1024llu)
@@ -205,9 +206,82 @@ next_highest_pow_2_u64(u64 v)
     return v;
 }
 
+//
+// Atomics
+//
+// Thin wrappers over the compiler builtins with C11 memory orders. The plain versions are
+// sequentially consistent, the _explicit versions take one of the atomic_order values.
+//
+
+typedef enum
+{
+    atomic_order_relaxed = __ATOMIC_RELAXED,
+    atomic_order_acquire = __ATOMIC_ACQUIRE,
+    atomic_order_release = __ATOMIC_RELEASE,
+    atomic_order_acq_rel = __ATOMIC_ACQ_REL,
+    atomic_order_seq_cst = __ATOMIC_SEQ_CST,
+} atomic_order;
+
+#define DEFINE_ATOMIC_OPS(Type, Name)                                                                           \
+    fn_inline Type atomic_load_explicit_##Name(Type volatile* Ptr, atomic_order Order)                          \
+    { return __atomic_load_n(Ptr, Order); }                                                                     \
+    fn_inline void atomic_store_explicit_##Name(Type volatile* Ptr, Type Value, atomic_order Order)             \
+    { __atomic_store_n(Ptr, Value, Order); }                                                                    \
+    fn_inline Type atomic_exchange_explicit_##Name(Type volatile* Ptr, Type Value, atomic_order Order)          \
+    { return __atomic_exchange_n(Ptr, Value, Order); }                                                          \
+    /* On failure, Expected is updated with the current value */                                                \
+    fn_inline bool atomic_compare_exchange_explicit_##Name(Type volatile* Ptr, Type* Expected, Type Desired,    \
+        atomic_order Success, atomic_order Failure)                                                             \
+    { return __atomic_compare_exchange_n(Ptr, Expected, Desired, false, Success, Failure); }                    \
+    fn_inline Type atomic_load_##Name(Type volatile* Ptr)                                                       \
+    { return atomic_load_explicit_##Name(Ptr, atomic_order_seq_cst); }                                          \
+    fn_inline void atomic_store_##Name(Type volatile* Ptr, Type Value)                                          \
+    { atomic_store_explicit_##Name(Ptr, Value, atomic_order_seq_cst); }                                         \
+    fn_inline Type atomic_exchange_##Name(Type volatile* Ptr, Type Value)                                       \
+    { return atomic_exchange_explicit_##Name(Ptr, Value, atomic_order_seq_cst); }                               \
+    fn_inline bool atomic_compare_exchange_##Name(Type volatile* Ptr, Type* Expected, Type Desired)             \
+    { return atomic_compare_exchange_explicit_##Name(Ptr, Expected, Desired,                                    \
+        atomic_order_seq_cst, atomic_order_seq_cst); }
+
+// Integer only operations, fetch_add and fetch_sub return the previous value.
+#define DEFINE_ATOMIC_INTEGER_OPS(Type, Name)                                                                   \
+    DEFINE_ATOMIC_OPS(Type, Name)                                                                               \
+    fn_inline Type atomic_fetch_add_explicit_##Name(Type volatile* Ptr, Type Value, atomic_order Order)         \
+    { return __atomic_fetch_add(Ptr, Value, Order); }                                                           \
+    fn_inline Type atomic_fetch_sub_explicit_##Name(Type volatile* Ptr, Type Value, atomic_order Order)         \
+    { return __atomic_fetch_sub(Ptr, Value, Order); }                                                           \
+    fn_inline Type atomic_fetch_add_##Name(Type volatile* Ptr, Type Value)                                      \
+    { return atomic_fetch_add_explicit_##Name(Ptr, Value, atomic_order_seq_cst); }                              \
+    fn_inline Type atomic_fetch_sub_##Name(Type volatile* Ptr, Type Value)                                      \
+    { return atomic_fetch_sub_explicit_##Name(Ptr, Value, atomic_order_seq_cst); }
+
+DEFINE_ATOMIC_INTEGER_OPS(s32, s32)
+DEFINE_ATOMIC_INTEGER_OPS(u32, u32)
+DEFINE_ATOMIC_INTEGER_OPS(s64, s64)
+DEFINE_ATOMIC_INTEGER_OPS(u64, u64)
+DEFINE_ATOMIC_OPS(void*, ptr)
+
+fn_inline void atomic_thread_fence(atomic_order Order) { __atomic_thread_fence(Order); }
+
+// Hint to the cpu that we are in a spin-wait loop
+fn_inline void atomic_pause()
+{
+#if defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
+
 #include <time.h>
 fn_inline f64 clock_ms(clock_t Start, clock_t End) {
     return ((f64)(End - Start) / (f64)CLOCKS_PER_SEC) * 1000.0;
 }
 
+// clock() measures cpu time of the whole process, which adds up across threads. Use the
+// wall clock to time multithreaded code.
+fn_inline f64 wall_clock_ms() {
+    struct timespec Time;
+    timespec_get(&Time, TIME_UTC);
+    return ((f64)Time.tv_sec * 1000.0) + ((f64)Time.tv_nsec / 1000000.0);
+}
+
 #endif //_TYPES_H_
@@ -0,0 +1,38 @@
+#ifndef _JOB_SYSTEM_H_
+#define _JOB_SYSTEM_H_
+
+#include "chibi_types.h"
+
+//
+// Work stealing job system
+//
+// Every worker owns a Chase-Lev deque. Jobs submitted from a worker are pushed to the bottom
+// of its own deque, the owner pops from the bottom while idle workers steal from the top of
+// other workers' deques. The thread calling job_system_init becomes worker 0, so jobs can
+// only be submitted from the main thread or from inside of other jobs.
+//
+
+typedef void job_fn(void* Data);
+
+// Tracks a group of jobs. Incremented on submit and decremented when a job completes.
+typedef struct
+{
+    s32 volatile Value;
+} job_counter;
+
+// Starts WorkerCount - 1 worker threads.
+void job_system_init(u32 WorkerCount);
+void job_system_shutdown();
+u32  job_system_worker_count();
+
+// Counter may be NULL if the caller doesn't need to wait for the job.
+void job_submit(job_fn* Fn, void* Data, job_counter* Counter);
+// Runs pending jobs on the calling thread until Counter reaches zero.
+void job_wait(job_counter* Counter);
+
+// Calls Fn over [Start, End) in sub-ranges of at most Grain elements, returns once every
+// sub-range has been processed.
+typedef void parallel_for_fn(u64 Start, u64 End, void* Data);
+void parallel_for(u64 Start, u64 End, u64 Grain, parallel_for_fn* Fn, void* Data);
+
+#endif //_JOB_SYSTEM_H_
@@ -1,7 +1,15 @@
+// GNU extensions (cpu_set_t, memmem, REG_RIP), needed before the first system include
+#if !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE
+#endif
+
 #include "chibi_types.h"
 #include "platform.h"
 #include "chibi_core.h"
+#include "chibi_memory.h"
 #include "darray.h"
+#include "job_system.h"
+#include "pool.h"
 
 int main(void)
 {
@@ -9,9 +17,12 @@ int main(void)
     void* Logger = mem_alloc(byte, LoggerSize);
     logger_initialize(Logger);
 
+    job_system_init(platform_thread_get_core_count());
+
     // Now do it...
     log_info("Hello advent of code");
 
+    job_system_shutdown();
     return 0;
 }
 
@@ -21,5 +32,8 @@ int main(void)
 // Source Code from ther files
 
 #include "chibi_core.c" 
+#include "chibi_memory.c"
 #include "darray.c"
+#include "job_system.c"
+#include "pool.c"
 #include "platform_unix.c"
\ No newline at end of file
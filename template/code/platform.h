@@ -56,6 +56,33 @@ bool platform_file_exists(const char* Filepath);
 void platform_mkdir(const char* Filepath);
 
 file_io_read_result platform_read_entire_file(const char* Filepath);
+typedef enum
+{
+    file_map_none       = 0x00,
+    file_map_populate   = 0x01, // Fault in every page when mapping instead of on first access
+    file_map_sequential = 0x02, // Hint that the file will be read front to back
+} file_map_flags;
+
+// Maps a file read-only in to the address space instead of copying it in to a heap buffer.
+// Unlike platform_read_entire_file the data is NOT null terminated. MapFlags is a bitmask
+// of file_map_flags. Release the view with platform_unmap_file.
+file_io_read_result platform_map_file(const char* Filepath, int MapFlags);
+void platform_unmap_file(file_io_read_result* MappedFile);
+
+// Streaming reads, for inputs that are too large to load at once or that can't be mapped
+// (pipes). Passing NULL or "-" as the Filepath reads from stdin.
+typedef struct
+{
+    int  Handle;
+    bool OwnsHandle;
+} platform_file_stream;
+
+file_io_error platform_open_file_stream(const char* Filepath, platform_file_stream* OutStream);
+// Returns the number of bytes read, which can be less than BufferSize. Returns 0 at the end
+// of the stream and -1 on failure.
+s64 platform_read_file_stream(platform_file_stream* Stream, void* Buffer, u64 BufferSize);
+void platform_close_file_stream(platform_file_stream* Stream);
+
 file_io_error platform_write_entire_file(const char* Filepath, void* FileData, u64 NumBytesToWrite, bool Append);
 
 void* platform_load_library(const char* Library);
@@ -68,7 +95,54 @@ void* platform_load_function(void* Library, const char* FunctionName);
 
 u32 platform_get_page_size();
 void platform_virtual_free(void* Ptr, u64 AllocationSize);
+// Returns NULL if the address space couldn't be reserved. Does not log.
 void* platform_virtual_reserve_memory(u64 Size);
 void platform_virtual_map_to_physical(void* BasePtr, u64 Offset, u64 PageRange);
 
+//
+// Threads
+//
+
+// Storage for the platform's threading primitives. The handles are opaque and sized to hold
+// the native types (pthread on Linux), initialize them with the matching init function.
+typedef struct { u64 Handle;     } platform_thread;
+typedef struct { u64 Opaque[8];  } platform_mutex;
+typedef struct { u64 Opaque[8];  } platform_condition_variable;
+typedef struct { u64 Opaque[4];  } platform_semaphore;
+typedef struct { u64 Handle;     } platform_tls;
+
+typedef void* platform_thread_proc(void* Data);
+
+bool platform_thread_create(platform_thread* Thread, platform_thread_proc* Proc, void* Data);
+void* platform_thread_join(platform_thread* Thread);
+platform_thread platform_thread_current();
+void platform_thread_yield();
+u32  platform_thread_get_core_count();
+// Pins the thread to a single logical core. Returns false if the platform refused.
+bool platform_thread_set_affinity(platform_thread* Thread, u32 CoreIndex);
+
+void platform_mutex_init(platform_mutex* Mutex);
+void platform_mutex_deinit(platform_mutex* Mutex);
+void platform_mutex_lock(platform_mutex* Mutex);
+bool platform_mutex_try_lock(platform_mutex* Mutex);
+void platform_mutex_unlock(platform_mutex* Mutex);
+
+void platform_condition_variable_init(platform_condition_variable* ConditionVariable);
+void platform_condition_variable_deinit(platform_condition_variable* ConditionVariable);
+// Mutex must be locked by the caller, it is locked again when wait returns.
+void platform_condition_variable_wait(platform_condition_variable* ConditionVariable, platform_mutex* Mutex);
+void platform_condition_variable_signal(platform_condition_variable* ConditionVariable);
+void platform_condition_variable_broadcast(platform_condition_variable* ConditionVariable);
+
+void platform_semaphore_init(platform_semaphore* Semaphore, u32 InitialCount);
+void platform_semaphore_deinit(platform_semaphore* Semaphore);
+void platform_semaphore_wait(platform_semaphore* Semaphore);
+void platform_semaphore_post(platform_semaphore* Semaphore);
+
+// Thread local storage slots. Every thread sees its own value for a slot, initially NULL.
+bool  platform_tls_alloc(platform_tls* Slot);
+void  platform_tls_free(platform_tls* Slot);
+void  platform_tls_set(platform_tls* Slot, void* Value);
+void* platform_tls_get(platform_tls* Slot);
+
 #endif //_PLATFORM_H_
@@ -0,0 +1,241 @@
+#include "pool.h"
+#include "chibi_core.h"
+#include "platform.h"
+
+fn_internal void
+pool_lock(memory_pool* Pool)
+{
+    while (atomic_exchange_explicit_u32(&Pool->Lock, 1, atomic_order_acquire))
+    {
+        while (atomic_load_explicit_u32(&Pool->Lock, atomic_order_relaxed))
+            atomic_pause();
+    }
+}
+
+fn_internal void
+pool_unlock(memory_pool* Pool)
+{
+    atomic_store_explicit_u32(&Pool->Lock, 0, atomic_order_release);
+}
+
+// Bumps up to Count fresh blocks off the end of the range, committing pages as needed.
+// Pool must be locked. Returns the number of blocks, which are contiguous from *OutFirst.
+fn_internal u64
+pool_bump_locked(memory_pool* Pool, u64 Count, u8** OutFirst)
+{
+    u64 Available = (Pool->ReserveSize - Pool->Pos) / Pool->BlockSize;
+    if (Count > Available) Count = Available;
+    if (Count == 0) return 0;
+
+    u64 End = Pool->Pos + Count * Pool->BlockSize;
+    if (End > Pool->CommitSize)
+    {
+        u64 NewCommitSize = forward_align(End, POOL_COMMIT_SIZE);
+        if (NewCommitSize > Pool->ReserveSize) NewCommitSize = Pool->ReserveSize;
+
+        platform_virtual_map_to_physical(Pool->Base, Pool->CommitSize, NewCommitSize - Pool->CommitSize);
+        Pool->CommitSize = NewCommitSize;
+    }
+
+    *OutFirst = Pool->Base + Pool->Pos;
+    Pool->Pos = End;
+    return Count;
+}
+
+memory_pool pool_init(u64 BlockSize, u64 Alignment, u64 MaxBlockCount)
+{
+    cassert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0);
+    cassert_custom(Alignment <= platform_get_page_size(), "Pool blocks can't be aligned past a page.");
+
+    // Free blocks hold the list link, so a block is at least a pointer in size
+    if (BlockSize < sizeof(pool_block))  BlockSize = sizeof(pool_block);
+    if (Alignment < _Alignof(pool_block)) Alignment = _Alignof(pool_block);
+
+    memory_pool Result = {0};
+    Result.BlockSize   = forward_align(BlockSize, Alignment);
+    Result.ReserveSize = forward_align(Result.BlockSize * MaxBlockCount, POOL_COMMIT_SIZE);
+    Result.Base        = platform_virtual_reserve_memory(Result.ReserveSize);
+
+    if (!Result.Base)
+    { // Leave the pool empty, pool_alloc then returns NULL
+        log_error("Failed to reserve %lu bytes for a memory pool.", Result.ReserveSize);
+        Result.ReserveSize = 0;
+    }
+
+    return Result;
+}
+
+void pool_release(memory_pool* Pool)
+{
+    if (Pool->Base)
+        platform_virtual_free(Pool->Base, Pool->ReserveSize);
+    mem_zero(Pool, sizeof(memory_pool));
+}
+
+void* pool_alloc(memory_pool* Pool)
+{
+    pool_lock(Pool);
+
+    void* Result = Pool->FreeList;
+    if (Result)
+    {
+        Pool->FreeList = Pool->FreeList->Next;
+    }
+    else
+    {
+        u8* Block = NULL;
+        if (pool_bump_locked(Pool, 1, &Block))
+            Result = Block;
+    }
+
+    pool_unlock(Pool);
+    return Result;
+}
+
+void pool_free(memory_pool* Pool, void* Block)
+{
+    if (!Block) return;
+    cassert((u8*)Block >= Pool->Base && (u8*)Block < Pool->Base + Pool->ReserveSize);
+
+    pool_block* Free = (pool_block*)Block;
+
+    pool_lock(Pool);
+    Free->Next     = Pool->FreeList;
+    Pool->FreeList = Free;
+    pool_unlock(Pool);
+}
+
+void pool_reset(memory_pool* Pool)
+{
+    pool_lock(Pool);
+    Pool->Pos      = 0;
+    Pool->FreeList = NULL;
+    atomic_store_explicit_u32(&Pool->Generation, Pool->Generation + 1, atomic_order_relaxed);
+    pool_unlock(Pool);
+}
+
+//
+// Per-thread caches
+//
+
+pool_cache pool_cache_init(memory_pool* Pool)
+{
+    pool_cache Result = {0};
+    Result.Pool       = Pool;
+    Result.Generation = atomic_load_explicit_u32(&Pool->Generation, atomic_order_relaxed);
+    return Result;
+}
+
+// Drops the cached blocks if the pool was reset since they were taken.
+fn_internal void
+pool_cache_check_generation(pool_cache* Cache)
+{
+    u32 Generation = atomic_load_explicit_u32(&Cache->Pool->Generation, atomic_order_relaxed);
+    if (Cache->Generation != Generation)
+    {
+        Cache->FreeList   = NULL;
+        Cache->Count      = 0;
+        Cache->Generation = Generation;
+    }
+}
+
+// Splices the first Count blocks of the cache back on to the pool's free list.
+fn_internal void
+pool_cache_give_back(pool_cache* Cache, u32 Count)
+{
+    if (Count == 0) return;
+
+    pool_block* First = Cache->FreeList;
+    pool_block* Last  = First;
+    for (u32 i = 1; i < Count; ++i)
+        Last = Last->Next;
+
+    Cache->FreeList = Last->Next;
+    Cache->Count   -= Count;
+
+    memory_pool* Pool = Cache->Pool;
+    pool_lock(Pool);
+    Last->Next     = Pool->FreeList;
+    Pool->FreeList = First;
+    pool_unlock(Pool);
+}
+
+// Takes a batch of blocks from the pool, free blocks first, then fresh ones off the range.
+fn_internal void
+pool_cache_refill(pool_cache* Cache)
+{
+    memory_pool* Pool = Cache->Pool;
+
+    u32 Count = 0;
+    u8* Fresh = NULL;
+    u64 FreshCount = 0;
+
+    pool_lock(Pool);
+    if (Pool->FreeList)
+    {
+        pool_block* First = Pool->FreeList;
+        pool_block* Last  = First;
+        Count = 1;
+        while (Count < POOL_CACHE_BATCH && Last->Next)
+        {
+            Last = Last->Next;
+            ++Count;
+        }
+
+        Pool->FreeList = Last->Next;
+        Last->Next     = Cache->FreeList;
+        Cache->FreeList = First;
+    }
+    else
+    {
+        FreshCount = pool_bump_locked(Pool, POOL_CACHE_BATCH, &Fresh);
+    }
+    pool_unlock(Pool);
+
+    // Fresh blocks belong to this cache now, link them up outside of the lock
+    for (u64 i = FreshCount; i > 0; --i)
+    {
+        pool_block* Block = (pool_block*)(Fresh + (i - 1) * Pool->BlockSize);
+        Block->Next     = Cache->FreeList;
+        Cache->FreeList = Block;
+    }
+
+    Cache->Count += Count + (u32)FreshCount;
+}
+
+void pool_cache_flush(pool_cache* Cache)
+{
+    pool_cache_check_generation(Cache);
+    pool_cache_give_back(Cache, Cache->Count);
+}
+
+void* pool_cache_alloc(pool_cache* Cache)
+{
+    pool_cache_check_generation(Cache);
+
+    if (!Cache->FreeList)
+    {
+        pool_cache_refill(Cache);
+        if (!Cache->FreeList) return NULL;
+    }
+
+    pool_block* Result = Cache->FreeList;
+    Cache->FreeList = Result->Next;
+    Cache->Count   -= 1;
+    return Result;
+}
+
+void pool_cache_free(pool_cache* Cache, void* Block)
+{
+    if (!Block) return;
+    pool_cache_check_generation(Cache);
+
+    pool_block* Free = (pool_block*)Block;
+    Free->Next      = Cache->FreeList;
+    Cache->FreeList = Free;
+    Cache->Count   += 1;
+
+    // Keep one batch around, hand the rest back so other threads can use them
+    if (Cache->Count >= 2 * POOL_CACHE_BATCH)
+        pool_cache_give_back(Cache, POOL_CACHE_BATCH);
+}
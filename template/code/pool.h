@@ -0,0 +1,71 @@
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include "chibi_types.h"
+
+//
+// Pool Allocator
+//
+// Fixed size blocks carved out of a reserved range of address space. Free blocks are kept
+// on an intrusive free list threaded through the blocks themselves, fresh blocks are bumped
+// off the end of the range and pages are committed as the pool grows. Every block is released
+// at once with pool_reset.
+//
+// pool_alloc and pool_free take a spin lock, so a pool can be shared between threads. Threads
+// that allocate a lot can go through a pool_cache instead, which only touches the pool to
+// move blocks in batches.
+//
+
+#define POOL_COMMIT_SIZE _64KB // Granularity of commits, a multiple of the page size
+#define POOL_CACHE_BATCH 64    // Blocks moved between a cache and its pool at a time
+
+typedef struct pool_block
+{
+    struct pool_block* Next;
+} pool_block;
+
+typedef struct
+{
+    u8* Base;
+    u64 ReserveSize;
+    u64 CommitSize;
+    u64 Pos;        // Bytes bumped off the range so far
+    u64 BlockSize;  // Stride between blocks, includes alignment padding
+
+    pool_block*  FreeList;
+    u32 volatile Lock;
+    u32          Generation; // Bumped by pool_reset so caches can drop stale blocks
+} memory_pool;
+
+// Per-thread cache of free blocks. Must only be used by one thread at a time.
+typedef struct
+{
+    memory_pool* Pool;
+    pool_block*  FreeList;
+    u32          Count;
+    u32          Generation;
+} pool_cache;
+
+#define pool_init_type(Type, MaxCount) pool_init(sizeof(Type), _Alignof(Type), MaxCount)
+#define pool_alloc_type(Pool, Type)    (Type*)pool_alloc(Pool)
+
+// Reserves space for MaxBlockCount blocks. Alignment must be a power of 2. If the space can't
+// be reserved the pool's Base is NULL and every allocation returns NULL.
+memory_pool pool_init(u64 BlockSize, u64 Alignment, u64 MaxBlockCount);
+void pool_release(memory_pool* Pool);
+
+// Returns NULL if the pool is out of reserved space. Memory is not zeroed.
+void* pool_alloc(memory_pool* Pool);
+void  pool_free(memory_pool* Pool, void* Block);
+// Frees every block, committed pages are kept for reuse. Blocks held by caches are dropped
+// the next time the cache is used.
+void  pool_reset(memory_pool* Pool);
+
+pool_cache pool_cache_init(memory_pool* Pool);
+// Returns the cached blocks to the pool.
+void  pool_cache_flush(pool_cache* Cache);
+
+void* pool_cache_alloc(pool_cache* Cache);
+void  pool_cache_free(pool_cache* Cache, void* Block);
+
+#endif //_POOL_H_